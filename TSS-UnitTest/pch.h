@@ -4,5 +4,17 @@
 
 #pragma once
 
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
 #include "gtest/gtest.h"
 #include "../TimeSeriesTransformations/TimeSeriesTransformations.h"
+#include "../TimeSeriesTransformations/MappedFile.h"
+#include "../TimeSeriesTransformations/DateTime.h"
+#include "../TimeSeriesTransformations/TimeSeriesPanel.h"
+#include "../TimeSeriesTransformations/ConcurrentTimeSeries.h"
+#include "../TimeSeriesTransformations/TickQueue.h"
+#include "../TimeSeriesTransformations/ChunkedTimeSeries.h"
@@ -2,6 +2,8 @@
 
 
 std::string filepath = "C:\\Users\\Admin\\source\\repos\\Connor-Colenso\\TimeSeriesTransformations-Library\\";
+// Files the tests generate go to the temp directory rather than next to the fixtures.
+std::string temppath = (std::filesystem::temp_directory_path() / "").string();
 
 TEST(TimeSeriesTransformations, loadFileExaminationFile) {
 
@@ -493,3 +495,1116 @@ TEST(TimeSeriesTransformations, printPricesOnTrickyDay) {
     EXPECT_THROW(v.printSharePricesOnDate("1970-02-31"), std::invalid_argument);
     EXPECT_THROW(v.printSharePricesOnDate("1970-02-31 00:00:00"), std::invalid_argument);
 }
+
+// Loader edge cases.
+TEST(TimeSeriesTransformations, loadFileWithWindowsLineEndings) {
+    {
+        std::ofstream csv(temppath + "CRLF_TEST.csv", std::ios::binary);
+        csv << "TIMESTAMP,ShareY\r\n3,1.5\r\n1,2.123456789\r\n\r\n2,3\r\n";
+    }
+
+    TimeSeriesTransformations v(temppath + "CRLF_TEST.csv");
+
+    EXPECT_EQ(v.getName(), "ShareY");
+    EXPECT_EQ(v.count(), 3);
+    EXPECT_EQ(v.getTimeVector(), std::vector<int>({ 1, 2, 3 }));
+    EXPECT_NEAR(v.getPriceVector()[0], 2.12346, 10e-9);
+    EXPECT_EQ(v.getPriceVector()[2], 1.5);
+}
+
+TEST(TimeSeriesTransformations, throwInvalidArgumentFromMalformedRow) {
+    {
+        std::ofstream csv(temppath + "MALFORMED_TEST.csv");
+        csv << "TIMESTAMP,ShareX\n1,1.5\nabc,2\n";
+    }
+
+    EXPECT_THROW(TimeSeriesTransformations v(temppath + "MALFORMED_TEST.csv"), std::invalid_argument);
+}
+
+// Memory mapped ingestion.
+TEST(MappedFile, mapsExistingFile) {
+    MappedFile mapped(filepath + "empty_with_header.csv");
+
+    ASSERT_TRUE(mapped.isMapped());
+    EXPECT_EQ(std::string(mapped.data(), 9), "TIMESTAMP");
+}
+
+TEST(MappedFile, leavesMissingFileUnmapped) {
+    MappedFile mapped(filepath + "file_does_not_exist.csv");
+
+    EXPECT_FALSE(mapped.isMapped());
+    EXPECT_EQ(mapped.size(), 0);
+}
+
+// Parallel chunked loading.
+TEST(TimeSeriesTransformations, parallelLoadMatchesSerialLoad) {
+    TimeSeriesTransformations serial(filepath + "Problem3_DATA.csv");
+
+    // Counts beyond the core count split the file that many ways without starting that many threads.
+    for (unsigned int threads : { 1u, 2u, 3u, 8u, 5000u }) {
+        TimeSeriesTransformations parallel = TimeSeriesTransformations::load(filepath + "Problem3_DATA.csv", threads);
+        EXPECT_TRUE(parallel == serial);
+    }
+}
+
+TEST(TimeSeriesTransformations, parallelLoadMergesUnorderedChunks) {
+    {
+        std::ofstream csv(temppath + "CHUNKS_TEST.csv");
+        csv << "TIMESTAMP,ShareX\n";
+        for (int chunk = 3; chunk >= 0; chunk--) {
+            for (int i = 0; i < 50; i++) {
+                csv << chunk * 1000 + i * 2 << "," << chunk << "\n";
+            }
+        }
+    }
+
+    TimeSeriesTransformations v = TimeSeriesTransformations::load(temppath + "CHUNKS_TEST.csv", 4);
+    std::vector<int> times = v.getTimeVector();
+
+    EXPECT_EQ(v.count(), 200);
+    EXPECT_TRUE(std::is_sorted(times.begin(), times.end()));
+    EXPECT_EQ(times.front(), 0);
+    EXPECT_EQ(times.back(), 3098);
+}
+
+// Binary snapshots.
+TEST(TimeSeriesTransformations, binaryRoundTrip) {
+    TimeSeriesTransformations v(filepath + "Problem3_DATA.csv");
+    v.separator = '|';
+    v.saveBinary(temppath + "TEST_SAVE.tsb");
+
+    TimeSeriesTransformations v_1 = TimeSeriesTransformations::loadBinary(temppath + "TEST_SAVE.tsb");
+    EXPECT_TRUE(v == v_1);
+
+    TimeSeriesTransformations empty({}, {}, "APPL");
+    empty.saveBinary(temppath + "EMPTY_SAVE.tsb");
+
+    TimeSeriesTransformations empty_1 = TimeSeriesTransformations::loadBinary(temppath + "EMPTY_SAVE.tsb");
+    EXPECT_EQ(empty_1.count(), 0);
+    EXPECT_EQ(empty_1.getName(), "APPL");
+}
+
+TEST(TimeSeriesTransformations, throwRuntimeErrorFromInvalidBinaryFile) {
+    EXPECT_THROW(TimeSeriesTransformations::loadBinary(filepath + "Problem3_DATA.csv"), std::runtime_error);
+    EXPECT_THROW(TimeSeriesTransformations::loadBinary(filepath + "empty_with_header.csv"), std::runtime_error);
+    EXPECT_THROW(TimeSeriesTransformations::loadBinary(filepath + "file_does_not_exist.tsb"), std::runtime_error);
+}
+
+TEST(TimeSeriesTransformations, throwRuntimeErrorFromCorruptBinaryTimes) {
+    TimeSeriesTransformations v({ 10, 20 }, { 1.5, 2.5 }, "X");
+    v.saveBinary(temppath + "CORRUPT_SAVE.tsb");
+
+    std::ifstream in(temppath + "CORRUPT_SAVE.tsb", std::ios::binary);
+    std::string valid((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+
+    // The times follow the 40 byte header and the name padded to 8 bytes, maxTime is at byte 24.
+    const Timestamp late = 30;
+    std::string unsorted = valid;
+    std::memcpy(unsorted.data() + 48, &late, sizeof(late));
+    std::string wrongRange = valid;
+    std::memcpy(wrongRange.data() + 24, &late, sizeof(late));
+
+    for (const std::string& corrupt : { unsorted, wrongRange }) {
+        std::ofstream out(temppath + "CORRUPT_SAVE.tsb", std::ios::binary);
+        out.write(corrupt.data(), corrupt.size());
+        out.close();
+        EXPECT_THROW(TimeSeriesTransformations::loadBinary(temppath + "CORRUPT_SAVE.tsb"), std::runtime_error);
+    }
+}
+
+// Buffered csv writer.
+TEST(TimeSeriesTransformations, saveDataWithPrecision) {
+    TimeSeriesTransformations v({ 1, 2, 3 }, { 10, 1.23456789, -0.5 }, "APPL");
+    v.separator = ';';
+    v.saveData(temppath + "PRECISION_SAVE.csv", 2);
+
+    std::ifstream csv(temppath + "PRECISION_SAVE.csv");
+    std::stringstream contents;
+    contents << csv.rdbuf();
+
+    EXPECT_EQ(contents.str(), "TIMESTAMP;APPL\n1;10\n2;1.23\n3;-0.5\n");
+
+    // Default precision matches the 5 decimal places prices are loaded with.
+    TimeSeriesTransformations v_1({ 1 }, { 1.23456789 });
+    v_1.saveData(temppath + "PRECISION_SAVE.csv");
+
+    TimeSeriesTransformations v_2(temppath + "PRECISION_SAVE.csv");
+    EXPECT_EQ(v_2.getPriceVector()[0], 1.23457);
+}
+
+// Column views.
+TEST(TimeSeriesTransformations, columnViewsReadStorageWithoutCopying) {
+    TimeSeriesTransformations v({ 30, 10, 20 }, { 3, 1, 2 });
+
+    std::span<const Timestamp> times = v.getTimeView();
+    std::span<const double> prices = v.getPriceView();
+
+    ASSERT_EQ(times.size(), 3);
+    EXPECT_EQ(times[0], 10);
+    EXPECT_EQ(times[2], 30);
+    EXPECT_EQ(prices[0], 1);
+    EXPECT_EQ(prices[2], 3);
+
+    // Views alias the series storage rather than a copy of it.
+    EXPECT_EQ(prices.data(), v.getPriceView().data());
+}
+
+TEST(TimeSeriesTransformations, pairViewAndTimeRangeSlices) {
+    TimeSeriesTransformations v({ 10, 20, 30, 40, 50 }, { 1, 2, 3, 4, 5 });
+    TimePriceView view = v.getView();
+
+    EXPECT_EQ(view.size(), 5);
+    EXPECT_EQ(view[1], std::make_pair(Timestamp(20), 2.0));
+
+    std::vector<std::pair<int, double>> pairs(view.begin(), view.end());
+    EXPECT_EQ(pairs, v.getTimePricePairs());
+
+    // Both ends of a slice are inclusive.
+    TimePriceView slice = view.between(20, 40);
+    EXPECT_FALSE(slice.begin() == view.begin());
+    EXPECT_TRUE(slice.begin() == v.getView().between(20, 40).begin());
+
+    // Iterators from separate temporary views of the same rows mix.
+    EXPECT_EQ(std::distance(v.getView().begin(), v.getView().end()), 5);
+    std::vector<std::pair<Timestamp, double>> rows(v.getView().begin(), v.getView().end());
+    ASSERT_EQ(rows.size(), 5);
+    EXPECT_EQ(rows[4], std::make_pair(Timestamp(50), 5.0));
+    ASSERT_EQ(slice.size(), 3);
+    EXPECT_EQ(slice[0].first, 20);
+    EXPECT_EQ(slice[2].first, 40);
+
+    EXPECT_EQ(view.between(21, 29).size(), 0);
+    EXPECT_EQ(view.between(40, 20).size(), 0);
+    EXPECT_EQ(view.between(0, 100).size(), 5);
+}
+
+// Summary statistics kernel.
+TEST(TimeSeriesTransformations, summaryOfExaminationFile) {
+    TimeSeriesTransformations v(filepath + "Problem3_DATA.csv");
+
+    SummaryStatistics stats;
+    EXPECT_TRUE(v.summary(&stats));
+
+    std::vector<double> prices = v.getPriceVector();
+    EXPECT_EQ(stats.count, prices.size());
+    EXPECT_NEAR(stats.mean, 51.5734, 10e-5);
+    EXPECT_NEAR(std::sqrt(stats.variance), 28.703254238387661, 10e-6);
+    EXPECT_NEAR(stats.sum, stats.mean * stats.count, 10e-6);
+    EXPECT_EQ(stats.min, *std::min_element(prices.begin(), prices.end()));
+    EXPECT_EQ(stats.max, *std::max_element(prices.begin(), prices.end()));
+}
+
+TEST(TimeSeriesTransformations, summaryIsStableForLargeOffsets) {
+    // Naive sum of squares loses every significant digit of this variance.
+    std::vector<int> times(10001);
+    std::vector<double> prices(10001);
+    for (int i = 0; i <= 10000; i++) {
+        times[i] = i;
+        prices[i] = 1e9 + (i % 2);
+    }
+
+    TimeSeriesTransformations v(times, prices);
+    SummaryStatistics stats;
+    v.summary(&stats);
+
+    EXPECT_NEAR(stats.variance, 5000.0 * 5001.0 / (10001.0 * 10000.0), 10e-12);
+
+    TimeSeriesTransformations empty;
+    EXPECT_FALSE(empty.summary(&stats));
+    EXPECT_EQ(stats.count, 0);
+    EXPECT_TRUE(std::isnan(stats.mean));
+}
+
+TEST(TimeSeriesTransformations, summaryPropagatesNaNWherever) {
+    // Every length covers the SIMD body and scalar tail, 4100 also a second block.
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    for (size_t size : { 1, 2, 3, 5, 8, 13, 4100 }) {
+        for (size_t position = 0; position < size; position++) {
+            std::vector<double> values(size);
+            for (size_t i = 0; i < size; i++) {
+                values[i] = double(i % 7);
+            }
+            values[position] = nan;
+
+            SummaryStatistics stats = summarize(values);
+            EXPECT_EQ(stats.count, size);
+            EXPECT_TRUE(std::isnan(stats.mean) && std::isnan(stats.variance) && std::isnan(stats.min) && std::isnan(stats.max)) << size << " " << position;
+
+            if (size > 13 && position % 97 != 0) { continue; }
+            SummaryStatistics accumulated;
+            for (double value : values) {
+                accumulate(&accumulated, value);
+            }
+            EXPECT_TRUE(std::isnan(accumulated.min) && std::isnan(accumulated.max)) << size << " " << position;
+        }
+    }
+
+    SummaryStatistics clean = summarize(std::vector<double>{ 1, 2 });
+    SummaryStatistics dirty = summarize(std::vector<double>{ nan });
+    EXPECT_TRUE(std::isnan(mergeSummaries(clean, dirty).min));
+    EXPECT_TRUE(std::isnan(mergeSummaries(dirty, clean).max));
+}
+
+// Increment statistics kernel.
+TEST(TimeSeriesTransformations, incrementSummaryMatchesDiffSeries) {
+    TimeSeriesTransformations v(filepath + "Problem3_DATA.csv");
+
+    std::vector<double> prices = v.getPriceVector();
+    std::vector<double> diff(prices.size() - 1);
+    for (size_t i = 0; i + 1 < prices.size(); i++) {
+        diff[i] = prices[i + 1] - prices[i];
+    }
+
+    SummaryStatistics stats;
+    EXPECT_TRUE(v.incrementSummary(&stats));
+
+    EXPECT_EQ(stats.count, diff.size());
+    EXPECT_NEAR(stats.mean, 0.0029068986898690904, 10e-9);
+    EXPECT_NEAR(std::sqrt(stats.variance), 40.35944404799585, 10e-9);
+    EXPECT_EQ(stats.min, *std::min_element(diff.begin(), diff.end()));
+    EXPECT_EQ(stats.max, *std::max_element(diff.begin(), diff.end()));
+    EXPECT_EQ(stats.sum, prices.back() - prices.front());
+
+    TimeSeriesTransformations v_1({ 1 }, { 1 });
+    EXPECT_FALSE(v_1.incrementSummary(&stats));
+    EXPECT_EQ(stats.count, 0);
+}
+
+// Cached aggregates.
+TEST(TimeSeriesTransformations, cachedAggregatesFollowAppendsAndRemovals) {
+    TimeSeriesTransformations v({ 0, 10, 20 }, { 10, 12, 11 });
+
+    double value = 0.0;
+    v.mean(&value);
+    v.computeIncrementStandardDeviation(&value);
+
+    // In order appends update the cached state.
+    v.addASharePrice("1970-01-01 00:00:30", 15);
+    v.addASharePrice("1970-01-01 00:00:40", 9);
+
+    TimeSeriesTransformations fresh(v.getTimeVector(), v.getPriceVector());
+    SummaryStatistics cached, expected;
+
+    v.summary(&cached);
+    fresh.summary(&expected);
+    EXPECT_EQ(cached.count, expected.count);
+    EXPECT_NEAR(cached.mean, expected.mean, 10e-12);
+    EXPECT_NEAR(cached.variance, expected.variance, 10e-12);
+    EXPECT_EQ(cached.max, 15);
+
+    v.incrementSummary(&cached);
+    fresh.incrementSummary(&expected);
+    EXPECT_EQ(cached.count, 4);
+    EXPECT_NEAR(cached.variance, expected.variance, 10e-12);
+    EXPECT_EQ(cached.max, 4);
+
+    // An out of order tick and a removal both force the affected aggregates to be recomputed.
+    v.addASharePrice("1970-01-01 00:00:05", 10.5);
+    EXPECT_TRUE(v.findGreatestIncrements(&value));
+    EXPECT_EQ(value, 4);
+
+    EXPECT_TRUE(v.removePricesGreaterThan(14));
+    v.mean(&value);
+    EXPECT_NEAR(value, (10 + 10.5 + 12 + 11 + 9) / 5.0, 10e-12);
+    v.findGreatestIncrements(&value);
+    EXPECT_EQ(value, 1.5);
+}
+
+// Sorted insertion and batched appends.
+TEST(TimeSeriesTransformations, addASharePriceKeepsTimeOrder) {
+    TimeSeriesTransformations v({ 10, 20, 30 }, { 1, 2, 3 });
+
+    v.addASharePrice("1970-01-01 00:00:40", 4);
+    v.addASharePrice("1970-01-01 00:00:15", 5);
+    v.addASharePrice("1970-01-01 00:00:20", 6);
+
+    EXPECT_EQ(v.getTimeVector(), std::vector<int>({ 10, 15, 20, 20, 30, 40 }));
+    // Ticks at an existing time are placed after it.
+    EXPECT_EQ(v.getPriceVector(), std::vector<double>({ 1, 5, 2, 6, 3, 4 }));
+}
+
+TEST(TimeSeriesTransformations, addSharePricesMergesBatch) {
+    TimeSeriesTransformations v({ 10, 20, 30 }, { 1, 2, 3 });
+    double incrementMax = 0.0;
+    v.findGreatestIncrements(&incrementMax);
+
+    v.addSharePrices({ 50, 40 }, { 5, 4 });
+    EXPECT_EQ(v.getTimeVector(), std::vector<int>({ 10, 20, 30, 40, 50 }));
+    EXPECT_EQ(v.getPriceVector(), std::vector<double>({ 1, 2, 3, 4, 5 }));
+
+    v.addSharePrices({ 25, 5, 60 }, { 10, 0, 6 });
+    EXPECT_EQ(v.getTimeVector(), std::vector<int>({ 5, 10, 20, 25, 30, 40, 50, 60 }));
+    EXPECT_EQ(v.getPriceVector(), std::vector<double>({ 0, 1, 2, 10, 3, 4, 5, 6 }));
+
+    v.findGreatestIncrements(&incrementMax);
+    EXPECT_EQ(incrementMax, 8);
+
+    double meanValue = 0.0;
+    v.mean(&meanValue);
+    EXPECT_NEAR(meanValue, 31.0 / 8.0, 10e-12);
+
+    // A batch overlapping only the tail, equal times keep the existing row first.
+    v.addSharePrices({ 60, 55 }, { 7, 8 });
+    EXPECT_EQ(v.getTimeVector(), std::vector<int>({ 5, 10, 20, 25, 30, 40, 50, 55, 60, 60 }));
+    EXPECT_EQ(v.getPriceVector(), std::vector<double>({ 0, 1, 2, 10, 3, 4, 5, 8, 6, 7 }));
+
+    EXPECT_THROW(v.addSharePrices({ 1, 2 }, { 1 }), std::runtime_error);
+}
+
+// Binary search range queries.
+TEST(TimeSeriesTransformations, sliceBetweenDates) {
+    TimeSeriesTransformations v({ 10, 20, 30, 40, 50 }, { 1, 2, 3, 4, 5 });
+
+    TimePriceView slice = v.sliceBetween("1970-01-01 00:00:20", "1970-01-01 00:00:45");
+    ASSERT_EQ(slice.size(), 3);
+    EXPECT_EQ(slice[0], std::make_pair(Timestamp(20), 2.0));
+    EXPECT_EQ(slice[2], std::make_pair(Timestamp(40), 4.0));
+
+    EXPECT_EQ(v.sliceBetween("1970-01-01", "1970-01-02").size(), 5);
+    EXPECT_EQ(v.sliceBetween("1970-01-01 00:00:51", "1970-01-02").size(), 0);
+    EXPECT_THROW(v.sliceBetween("1970-02-31", "1970-03-01"), std::invalid_argument);
+}
+
+TEST(TimeSeriesTransformations, removeEntryAtTimeRemovesEveryTickAtThatTime) {
+    TimeSeriesTransformations v({ 10, 20, 20, 30 }, { 1, 2, 3, 4 });
+
+    EXPECT_TRUE(v.removeEntryAtTime("1970-01-01 00:00:20"));
+    EXPECT_EQ(v.getTimeVector(), std::vector<int>({ 10, 30 }));
+    EXPECT_EQ(v.getPriceVector(), std::vector<double>({ 1, 4 }));
+}
+
+// Date parsing.
+TEST(DateTime, parsesDatesAndTimesAsUtc) {
+    Timestamp unixEpoch = 0;
+
+    EXPECT_TRUE(parseDateTime("1970-01-01", &unixEpoch));
+    EXPECT_EQ(unixEpoch, 0);
+    EXPECT_TRUE(parseDateTime("2021-04-22 19:53:30", &unixEpoch));
+    EXPECT_EQ(unixEpoch, 1619121210);
+    EXPECT_TRUE(parseDateTime("1969-12-31 23:59:59", &unixEpoch));
+    EXPECT_EQ(unixEpoch, -1);
+    EXPECT_TRUE(parseDateTime("2000-02-29", &unixEpoch));
+    EXPECT_TRUE(parseDateTime("2038-01-19 03:14:07", &unixEpoch));
+    EXPECT_EQ(unixEpoch, 2147483647);
+    EXPECT_TRUE(parseDateTime("2038-01-19 03:14:08", &unixEpoch));
+    EXPECT_EQ(unixEpoch, 2147483648);
+    EXPECT_TRUE(parseDateTime("9999-12-31 23:59:59", &unixEpoch));
+    EXPECT_EQ(unixEpoch, 253402300799);
+
+    EXPECT_EQ(formatDateTime(1619121210), "2021-04-22 19:53:30");
+    EXPECT_EQ(formatDateTime(-1), "1969-12-31 23:59:59");
+    EXPECT_EQ(formatDateTime(951782400), "2000-02-29 00:00:00");
+    EXPECT_EQ(formatDateTime(4102444800), "2100-01-01 00:00:00");
+}
+
+TEST(DateTime, rejectsInvalidDates) {
+    Timestamp unixEpoch = 0;
+
+    EXPECT_FALSE(parseDateTime("2021-02-29", &unixEpoch));
+    EXPECT_FALSE(parseDateTime("1900-02-29", &unixEpoch));
+    EXPECT_FALSE(parseDateTime("1970-02-31 00:00:00", &unixEpoch));
+    EXPECT_FALSE(parseDateTime("1970-13-01", &unixEpoch));
+    EXPECT_FALSE(parseDateTime("1970-01-00", &unixEpoch));
+    EXPECT_FALSE(parseDateTime("1970-01-01 24:00:00", &unixEpoch));
+    EXPECT_FALSE(parseDateTime("1970-01-01 00:60:00", &unixEpoch));
+    EXPECT_FALSE(parseDateTime("1970-1-01", &unixEpoch));
+    EXPECT_FALSE(parseDateTime("1970-01-01T00:00:00", &unixEpoch));
+    EXPECT_FALSE(parseDateTime("1970-01-01 00:00", &unixEpoch));
+    EXPECT_FALSE(parseDateTime("", &unixEpoch));
+}
+
+TEST(DateTime, unixLiteralIsEvaluatedAtCompileTime) {
+    static_assert("1970-01-02"_unix == 86400);
+    static_assert("2021-04-22 19:53:30"_unix == 1619121210);
+    static_assert(unixTime("1969-12-31 23:59:59") == -1);
+
+    Timestamp unixEpoch = 0;
+    EXPECT_TRUE(parseDateTime("2021-04-22", &unixEpoch));
+    EXPECT_EQ(unixEpoch, "2021-04-22"_unix);
+}
+
+TEST(TimeSeriesTransformations, unixTimeOverloadsMatchDateStrings) {
+    TimeSeriesTransformations TSSObject;
+    TSSObject.addASharePrice("2021-04-22 09:30:00"_unix, 1.5);
+    TSSObject.addASharePrice("2021-04-22 16:00:00", 2.5);
+    TSSObject.addASharePrice("2021-04-23 09:30:00"_unix, 3.5);
+
+    double value = 0;
+    EXPECT_TRUE(TSSObject.getPriceAtDate("2021-04-22 16:00:00"_unix, &value));
+    EXPECT_EQ(value, 2.5);
+    EXPECT_EQ(TSSObject.printSharePricesOnDate("2021-04-22 10:00:00"_unix), TSSObject.printSharePricesOnDate("2021-04-22 10:00:00"));
+    EXPECT_EQ(TSSObject.printSharePricesOnDate("2021-04-22"_unix), "1.500000\n2.500000\n");
+    EXPECT_EQ(TSSObject.printIncrementsOnDate("2021-04-22"_unix), TSSObject.printIncrementsOnDate("2021-04-22"));
+    EXPECT_EQ(TSSObject.sliceBetween("2021-04-22"_unix, "2021-04-22 23:59:59"_unix).size(), 2);
+
+    EXPECT_TRUE(TSSObject.removePricesAfter("2021-04-22 16:00:00"_unix));
+    EXPECT_TRUE(TSSObject.removePricesBefore("2021-04-22 16:00:00"_unix));
+    EXPECT_TRUE(TSSObject.removeEntryAtTime("2021-04-22 16:00:00"_unix));
+    EXPECT_EQ(TSSObject.count(), 0);
+}
+
+TEST(TimeSeriesTransformations, dayIndexFollowsModifications) {
+    TimeSeriesTransformations TSSObject({ -10, 0, 100, 86399, 86400, 3 * 86400 }, { 1.0, 2.0, 4.0, 7.0, 11.0, 16.0 });
+
+    EXPECT_EQ(TSSObject.pricesOnDay(-1).size(), 1);
+    EXPECT_EQ(TSSObject.pricesOnDay(0).size(), 3);
+    EXPECT_EQ(TSSObject.pricesOnDay(2 * 86400).size(), 0);
+    EXPECT_EQ(TSSObject.pricesOnDay(5 * 86400).size(), 0);
+    EXPECT_EQ(TSSObject.printSharePricesOnDate(50), "4.000000\n7.000000\n");
+    EXPECT_EQ(TSSObject.printIncrementsOnDate(0), "1.000000\n2.000000\n3.000000\n");
+    EXPECT_EQ(TSSObject.printIncrementsOnDate(-10), "");
+
+    TSSObject.addASharePrice(2 * 86400, 20.0);
+    TSSObject.addSharePrices({ 86401 }, { 12.0 });
+    EXPECT_EQ(TSSObject.printSharePricesOnDate(86400), "11.000000\n12.000000\n");
+    EXPECT_EQ(TSSObject.printIncrementsOnDate(2 * 86400), "8.000000\n");
+
+    TSSObject.removePricesBefore(86400);
+    EXPECT_EQ(TSSObject.pricesOnDay(0).size(), 0);
+    EXPECT_EQ(TSSObject.printIncrementsOnDate(86400), "1.000000\n");
+}
+
+TEST(TimeSeriesTransformations, dayIndexExtendsOnInOrderAppends) {
+    TimeSeriesTransformations live({ 0, 100 }, { 1.0, 2.0 });
+    std::vector<int> times = { 0, 100 };
+    std::vector<double> prices = { 1.0, 2.0 };
+    EXPECT_EQ(live.pricesOnDay(0).size(), 2);
+
+    // The same day, a day after a gap of empty days, then a batch spanning several days.
+    live.addASharePrice(200, 3.0);
+    EXPECT_EQ(live.pricesOnDay(0).size(), 3);
+    live.addASharePrice(4 * 86400 + 5, 4.0);
+    EXPECT_EQ(live.pricesOnDay(2 * 86400).size(), 0);
+    live.addSharePrices({ 5 * 86400, 4 * 86400 + 9, 7 * 86400 }, { 6.0, 5.0, 7.0 });
+
+    times.insert(times.end(), { 200, 4 * 86400 + 5, 4 * 86400 + 9, 5 * 86400, 7 * 86400 });
+    prices.insert(prices.end(), { 3.0, 4.0, 5.0, 6.0, 7.0 });
+    TimeSeriesTransformations rebuilt(times, prices);
+
+    for (int day = -1; day <= 8; day++) {
+        EXPECT_EQ(live.printSharePricesOnDate(day * 86400), rebuilt.printSharePricesOnDate(day * 86400));
+    }
+}
+
+TEST(TimeSeriesTransformations, dayIndexOverWideSparseSpan) {
+    // Ten billion days apart, the index only holds the days that have rows.
+    const Timestamp far = 1000000000000000;
+    TimeSeriesTransformations sparse(TimeResolution::Seconds, { 0, far }, { 1.0, 2.0 });
+    EXPECT_EQ(sparse.printSharePricesOnDate(Timestamp(0)), "1.000000\n");
+    EXPECT_EQ(sparse.pricesOnDay(far).size(), 1);
+    EXPECT_EQ(sparse.pricesOnDay(far / 2).size(), 0);
+
+    sparse.addTick(far * 2, 3.0);
+    EXPECT_EQ(sparse.pricesOnDay(far * 2).size(), 1);
+    EXPECT_EQ(sparse.pricesOnDay(far + 86400).size(), 0);
+}
+
+TEST(TimeSeriesTransformations, millisecondTimestampsBeyondInt) {
+    // 2030-01-01 00:00:00 in milliseconds, which does not fit in an int.
+    const Timestamp start = "2030-01-01"_unix * 1000;
+    ASSERT_GT(start, std::numeric_limits<int>::max());
+
+    TimeSeriesTransformations v(TimeResolution::Milliseconds, { start + 1500, start, start + 250 }, { 3.0, 1.0, 2.0 }, "ShareX");
+    EXPECT_EQ(v.getResolution(), TimeResolution::Milliseconds);
+    EXPECT_EQ(v.getTimeView()[0], start);
+    EXPECT_EQ(v.getTimeView()[2], start + 1500);
+    EXPECT_THROW(v.getTimeVector(), std::overflow_error);
+
+    // Second based queries cover every tick within the second.
+    double value = 0;
+    EXPECT_TRUE(v.getPriceAtDate("2030-01-01 00:00:00", &value));
+    EXPECT_EQ(value, 1.0);
+    EXPECT_EQ(v.sliceBetween("2030-01-01 00:00:00", "2030-01-01 00:00:00").size(), 2);
+    EXPECT_EQ(v.printSharePricesOnDate("2030-01-01"), "1.000000\n2.000000\n3.000000\n");
+
+    v.addTick(start + 999, 2.5);
+    v.addASharePrice("2030-01-01 00:00:02", 4.0);
+    EXPECT_EQ(v.getTimeView()[4], start + 2000);
+    EXPECT_EQ(v.getView().between(start + 500, start + 1500).size(), 2);
+
+    EXPECT_TRUE(v.removeEntryAtTime("2030-01-01 00:00:00"));
+    EXPECT_EQ(v.count(), 2);
+
+    v.saveBinary(temppath + "TEST_SAVE_MS.tsb");
+    TimeSeriesTransformations loaded = TimeSeriesTransformations::loadBinary(temppath + "TEST_SAVE_MS.tsb");
+    EXPECT_TRUE(loaded == v);
+    EXPECT_EQ(loaded.getResolution(), TimeResolution::Milliseconds);
+}
+
+TEST(TimeSeriesTransformations, datesBeyond2038) {
+    static_assert("2040-01-01"_unix == 2208988800);
+    const Timestamp day = "2040-01-01"_unix;
+
+    TimeSeriesTransformations v;
+    v.addASharePrice("2040-01-01", 1.0);
+    v.addTick(day + 60, 2.0);
+    v.addASharePrice(day + 86400, 3.0);
+
+    double value = 0;
+    EXPECT_TRUE(v.getPriceAtDate("2040-01-01", &value));
+    EXPECT_EQ(value, 1.0);
+    EXPECT_EQ(v.printSharePricesOnDate("2040-01-01"), "1.000000\n2.000000\n");
+    EXPECT_EQ(v.pricesOnDay(day).size(), 2);
+    EXPECT_EQ(v.sliceBetween("2040-01-01", "2040-01-02").size(), 3);
+    EXPECT_EQ(v.query().after(day + 1).count(), 2);
+    EXPECT_EQ(v.resample(86400).start, std::vector<Timestamp>({ day, day + 86400 }));
+
+    EXPECT_TRUE(v.removePricesBefore("2040-01-01 00:01:00"));
+    EXPECT_TRUE(v.removePricesAfter(day + 60));
+    EXPECT_EQ(v.getPriceVector(), std::vector<double>({ 2.0 }));
+
+    ChunkedTimeSeries chunked;
+    chunked.addASharePrice("2040-01-01", 1.0);
+    EXPECT_TRUE(chunked.getPriceAtDate(day, &value));
+    ConcurrentTimeSeries concurrent;
+    concurrent.addASharePrice("2040-01-01", 1.0);
+    EXPECT_TRUE(concurrent.getPriceAtDate(day, &value));
+}
+
+TEST(TimeSeriesTransformations, loadCsvWithResolution) {
+    std::ofstream csv(temppath + "TEST_MICROSECONDS.csv");
+    csv << "TIMESTAMP,ShareX\n1893456000000002,2.5\n1893456000000001,1.5\n";
+    csv.close();
+
+    TimeSeriesTransformations v(temppath + "TEST_MICROSECONDS.csv", TimeResolution::Microseconds);
+    ASSERT_EQ(v.count(), 2);
+    EXPECT_EQ(v.getTimeView()[0], 1893456000000001);
+    EXPECT_EQ(v.pricesOnDay("2030-01-01"_unix).size(), 2);
+}
+
+TEST(TimeSeriesTransformations, loadVersionOneBinary) {
+    // A version 1 snapshot: int32 second times and no resolution byte.
+    std::ofstream file(temppath + "TEST_SAVE_V1.tsb", std::ios::binary);
+    const char header[40] = { 'T', 'S', 'T', 'B', 1, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 10, 0, 0, 0, 0, 0, 0, 0, 20, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, ',', 0, 0, 0 };
+    const char name[8] = { 'X' };
+    const std::int32_t times[2] = { 10, 20 };
+    const double prices[2] = { 1.5, 2.5 };
+    file.write(header, sizeof(header));
+    file.write(name, sizeof(name));
+    file.write(reinterpret_cast<const char*>(times), sizeof(times));
+    file.write(reinterpret_cast<const char*>(prices), sizeof(prices));
+    file.close();
+
+    TimeSeriesTransformations v = TimeSeriesTransformations::loadBinary(temppath + "TEST_SAVE_V1.tsb");
+    EXPECT_EQ(v.getName(), "X");
+    EXPECT_EQ(v.getResolution(), TimeResolution::Seconds);
+    EXPECT_EQ(v.getTimeVector(), std::vector<int>({ 10, 20 }));
+    EXPECT_EQ(v.getPriceVector(), std::vector<double>({ 1.5, 2.5 }));
+}
+
+// Rolling windows.
+TEST(TimeSeriesTransformations, rollingOverRowsMatchesWindowSummaries) {
+    std::vector<int> times;
+    std::vector<double> prices;
+    for (int i = 0; i < 200; i++) {
+        times.push_back(i);
+        // Large offset with small moves, the case naive running sums lose precision on.
+        prices.push_back(1e9 + std::sin(i * 0.7) * 3 + (i % 7));
+    }
+    TimeSeriesTransformations v(times, prices);
+
+    RollingStatistics rolling = v.rollingOverRows(10);
+    ASSERT_EQ(rolling.mean.size(), 200);
+
+    for (size_t i = 0; i < 200; i++) {
+        size_t first = (i >= 9) ? i - 9 : 0;
+        SummaryStatistics window = summarize(std::span<const double>(prices).subspan(first, i - first + 1));
+
+        EXPECT_EQ(rolling.count[i], window.count);
+        EXPECT_NEAR(rolling.mean[i], window.mean, 1e-6);
+        EXPECT_EQ(rolling.min[i], window.min);
+        EXPECT_EQ(rolling.max[i], window.max);
+        if (i > 0) {
+            EXPECT_NEAR(rolling.standardDeviation[i], std::sqrt(window.variance), 1e-6);
+        }
+    }
+    EXPECT_TRUE(std::isnan(rolling.standardDeviation[0]));
+    EXPECT_THROW(v.rollingOverRows(0), std::invalid_argument);
+}
+
+TEST(TimeSeriesTransformations, rollingOverSecondsUsesTimeWindows) {
+    TimeSeriesTransformations v({ 0, 1, 2, 10, 11, 30 }, { 5, 1, 3, 8, 2, 4 });
+
+    // Each window holds the prices of the last 5 seconds, (t - 5, t].
+    RollingStatistics rolling = v.rollingOverSeconds(5);
+    EXPECT_EQ(rolling.count, std::vector<size_t>({ 1, 2, 3, 1, 2, 1 }));
+    EXPECT_EQ(rolling.mean, std::vector<double>({ 5, 3, 3, 8, 5, 4 }));
+    EXPECT_EQ(rolling.min, std::vector<double>({ 5, 1, 1, 8, 2, 4 }));
+    EXPECT_EQ(rolling.max, std::vector<double>({ 5, 5, 5, 8, 8, 4 }));
+    EXPECT_DOUBLE_EQ(rolling.standardDeviation[2], 2.0);
+    EXPECT_THROW(v.rollingOverSeconds(0), std::invalid_argument);
+}
+
+// Resampling.
+TEST(TimeSeriesTransformations, resampleToOhlcBars) {
+    TimeSeriesTransformations v({ -5, 0, 30, 59, 60, 185, 190 }, { 7, 2, 5, 1, 4, 3, 6 });
+
+    OhlcBars bars = v.resample(60);
+    EXPECT_EQ(bars.start, std::vector<std::int64_t>({ -60, 0, 60, 180 }));
+    EXPECT_EQ(bars.open, std::vector<double>({ 7, 2, 4, 3 }));
+    EXPECT_EQ(bars.high, std::vector<double>({ 7, 5, 4, 6 }));
+    EXPECT_EQ(bars.low, std::vector<double>({ 7, 1, 4, 3 }));
+    EXPECT_EQ(bars.close, std::vector<double>({ 7, 1, 4, 6 }));
+    EXPECT_EQ(bars.count, std::vector<size_t>({ 1, 3, 1, 2 }));
+    EXPECT_EQ(bars.mean, std::vector<double>({ 7, 8.0 / 3, 4, 4.5 }));
+
+    EXPECT_EQ(TimeSeriesTransformations().resample(60).start.size(), 0);
+    EXPECT_THROW(v.resample(0), std::invalid_argument);
+}
+
+TEST(TimeSeriesTransformations, resampleMillisecondTicks) {
+    TimeSeriesTransformations v(TimeResolution::Milliseconds, { 999, 1000, 1500, 2001 }, { 1, 2, 3, 4 });
+
+    OhlcBars bars = v.resample(1);
+    EXPECT_EQ(bars.start, std::vector<std::int64_t>({ 0, 1000, 2000 }));
+    EXPECT_EQ(bars.count, std::vector<size_t>({ 1, 2, 1 }));
+    EXPECT_EQ(bars.close, std::vector<double>({ 1, 3, 4 }));
+}
+
+// Panels.
+TEST(TimeSeriesPanel, storesSeriesInOneArena) {
+    TimeSeriesPanel panel;
+    panel.addSeries(TimeSeriesTransformations({ 30, 10, 20 }, { 3, 1, 2 }, "ShareX"));
+    panel.addSeries("ShareY", { 15, 5 }, { 20, 10 });
+    panel.addSeries(TimeSeriesTransformations());
+
+    EXPECT_EQ(panel.seriesCount(), 3);
+    EXPECT_EQ(panel.count(), 5);
+    EXPECT_EQ(panel.getName(1), "ShareY");
+    EXPECT_EQ(panel.getView(0).getTimeView()[0], 10);
+    EXPECT_EQ(panel.getView(1)[0], std::make_pair(Timestamp(5), 10.0));
+    EXPECT_TRUE(panel.getView(2).empty());
+    EXPECT_TRUE(panel.getSeries(0) == TimeSeriesTransformations({ 10, 20, 30 }, { 1, 2, 3 }, "ShareX"));
+
+    size_t series = 0;
+    EXPECT_TRUE(panel.findSeries("ShareY", &series));
+    EXPECT_EQ(series, 1);
+    EXPECT_FALSE(panel.findSeries("ShareZ", &series));
+
+    EXPECT_THROW(panel.getView(3), std::out_of_range);
+    EXPECT_THROW(panel.addSeries(TimeSeriesTransformations(TimeResolution::Milliseconds, { 1 }, { 1 })), std::invalid_argument);
+}
+
+TEST(TimeSeriesPanel, statisticsAcrossSeries) {
+    TimeSeriesPanel panel;
+    for (int s = 0; s < 8; s++) {
+        std::vector<int> times;
+        std::vector<double> prices;
+        for (int i = 0; i < 1000 + s * 37; i++) {
+            times.push_back(i * 2);
+            prices.push_back(s * 100 + std::sin(i * 0.1));
+        }
+        panel.addSeries(TimeSeriesTransformations(times, prices, "Share" + std::to_string(s)));
+    }
+
+    // Parallel and single threaded runs agree with the series themselves.
+    std::vector<SummaryStatistics> parallel = panel.summaries(4);
+    std::vector<SummaryStatistics> single = panel.summaries(1);
+    std::vector<SummaryStatistics> increments = panel.incrementSummaries(3);
+    for (size_t s = 0; s < panel.seriesCount(); s++) {
+        SummaryStatistics expected, expectedIncrements;
+        panel.getSeries(s).summary(&expected);
+        panel.getSeries(s).incrementSummary(&expectedIncrements);
+        EXPECT_EQ(parallel[s].mean, expected.mean);
+        EXPECT_EQ(single[s].variance, expected.variance);
+        EXPECT_EQ(increments[s].max, expectedIncrements.max);
+    }
+
+    SummaryStatistics crossSection;
+    EXPECT_TRUE(panel.crossSection(3, &crossSection));
+    EXPECT_EQ(crossSection.count, 8);
+    EXPECT_NEAR(crossSection.mean, 350 + std::sin(0.1), 1e-9);
+    EXPECT_FALSE(panel.crossSection(-1, &crossSection));
+
+    // Cross sections take unix seconds whatever the panel resolution.
+    TimeSeriesPanel milliseconds(TimeResolution::Milliseconds);
+    milliseconds.addSeries("ShareX", { 1000, 2500, 3000 }, { 1, 2, 3 });
+    milliseconds.addSeries("ShareY", { 2999 }, { 4 });
+    EXPECT_TRUE(milliseconds.crossSection(2, &crossSection));
+    EXPECT_EQ(crossSection.count, 2);
+    EXPECT_EQ(crossSection.mean, 3);
+    EXPECT_TRUE(milliseconds.crossSection(1, &crossSection));
+    EXPECT_EQ(crossSection.count, 1);
+    EXPECT_EQ(crossSection.mean, 1);
+}
+
+TEST(TimeSeriesPanel, filtersCompactEverySeries) {
+    TimeSeriesPanel panel;
+    panel.addSeries(TimeSeriesTransformations({ 1, 2, 3, 4 }, { 1, 5, 2, 6 }, "ShareX"));
+    panel.addSeries(TimeSeriesTransformations({ 2, 3 }, { 7, 8 }, "ShareY"));
+    panel.addSeries(TimeSeriesTransformations({ 1, 4 }, { 1, 2 }, "ShareZ"));
+
+    EXPECT_TRUE(panel.removePricesGreaterThan(5));
+    EXPECT_EQ(panel.getView(0).getPriceView().size(), 3);
+    EXPECT_TRUE(panel.getView(1).empty());
+    EXPECT_EQ(panel.getView(2).size(), 2);
+
+    EXPECT_TRUE(panel.removePricesBefore(2));
+    EXPECT_TRUE(panel.removePricesAfter(3));
+    EXPECT_FALSE(panel.removePricesLowerThan(0));
+    EXPECT_EQ(panel.getSeries(0).getTimeVector(), std::vector<int>({ 2, 3 }));
+    EXPECT_TRUE(panel.getView(2).empty());
+    EXPECT_EQ(panel.count(), 2);
+}
+
+// Joins.
+TEST(TimeSeriesTransformations, asOfJoinTakesLastPriceAtOrBefore) {
+    TimeSeriesTransformations left({ 1, 5, 10, 12 }, { 1, 2, 3, 4 });
+    TimeSeriesTransformations right({ 3, 5, 5, 11 }, { 30, 50, 55, 110 });
+
+    AlignedSeries aligned = left.asOfJoin(right);
+    EXPECT_EQ(aligned.times, std::vector<Timestamp>({ 1, 5, 10, 12 }));
+    EXPECT_EQ(aligned.left, std::vector<double>({ 1, 2, 3, 4 }));
+    EXPECT_TRUE(std::isnan(aligned.right[0]));
+    EXPECT_EQ(aligned.right[1], 55);
+    EXPECT_EQ(aligned.right[2], 55);
+    EXPECT_EQ(aligned.right[3], 110);
+
+    EXPECT_THROW(left.asOfJoin(TimeSeriesTransformations(TimeResolution::Milliseconds, { 1 }, { 1 })), std::invalid_argument);
+}
+
+TEST(TimeSeriesTransformations, innerAndOuterJoins) {
+    TimeSeriesTransformations left({ 1, 2, 2, 4 }, { 1, 2, 3, 4 });
+    TimeSeriesTransformations right({ 2, 3, 4, 4 }, { 20, 30, 40, 41 });
+
+    AlignedSeries inner = left.innerJoin(right);
+    EXPECT_EQ(inner.times, std::vector<Timestamp>({ 2, 2, 4, 4 }));
+    EXPECT_EQ(inner.left, std::vector<double>({ 2, 3, 4, 4 }));
+    EXPECT_EQ(inner.right, std::vector<double>({ 20, 20, 40, 41 }));
+
+    AlignedSeries outer = left.outerJoin(right);
+    EXPECT_EQ(outer.times, std::vector<Timestamp>({ 1, 2, 2, 3, 4, 4 }));
+    EXPECT_EQ(outer.left[0], 1);
+    EXPECT_TRUE(std::isnan(outer.right[0]));
+    EXPECT_TRUE(std::isnan(outer.left[3]));
+    EXPECT_EQ(outer.right[3], 30);
+    EXPECT_EQ(outer.right[5], 41);
+
+    EXPECT_EQ(left.innerJoin(TimeSeriesTransformations()).times.size(), 0);
+    EXPECT_EQ(left.outerJoin(TimeSeriesTransformations()).times.size(), 4);
+}
+
+TEST(TimeSeriesTransformations, concurrentQueriesFillCachesOnce) {
+    std::vector<int> times(100000);
+    std::vector<double> prices(times.size());
+    for (size_t i = 0; i < times.size(); i++) {
+        times[i] = static_cast<int>(i * 60);
+        prices[i] = double(i % 97);
+    }
+    TimeSeriesTransformations series(times, prices);
+    SummaryStatistics expected = summarize(prices);
+
+    std::atomic<bool> consistent = true;
+    std::vector<std::thread> readers;
+    for (int reader = 0; reader < 4; reader++) {
+        readers.emplace_back([&] {
+            SummaryStatistics stats;
+            series.summary(&stats);
+            consistent = consistent && stats.count == expected.count && stats.sum == expected.sum;
+            series.incrementSummary(&stats);
+            consistent = consistent && stats.count == expected.count - 1;
+            consistent = consistent && series.pricesOnDay(86400).size() == 1440;
+            });
+    }
+    // Copies read the source's aggregates while the readers above may be filling them.
+    readers.emplace_back([&] {
+        TimeSeriesTransformations copy = series;
+        SummaryStatistics stats;
+        copy.summary(&stats);
+        consistent = consistent && stats.count == expected.count && stats.sum == expected.sum;
+        });
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_TRUE(consistent);
+}
+
+// Copy on write and move semantics.
+TEST(TimeSeriesTransformations, copiesShareColumnsUntilModified) {
+    TimeSeriesTransformations original({ 1, 2, 3 }, { 10, 20, 30 });
+    TimeSeriesTransformations copy = original;
+    EXPECT_EQ(copy.getPriceView().data(), original.getPriceView().data());
+
+    copy.removePricesGreaterThan(100);
+    EXPECT_FALSE(copy.removePricesBefore(1));
+    EXPECT_FALSE(copy.removePricesAfter(3));
+    EXPECT_FALSE(copy.removeEntryAtTime(7));
+    copy.addSharePrices({}, {});
+    EXPECT_THROW(copy.addTicks({ 1, 2 }, { 1 }), std::runtime_error);
+    EXPECT_EQ(copy.getPriceView().data(), original.getPriceView().data());
+
+    copy.addASharePrice(4, 40);
+    EXPECT_NE(copy.getPriceView().data(), original.getPriceView().data());
+    EXPECT_EQ(original.count(), 3);
+    EXPECT_EQ(copy.count(), 4);
+    EXPECT_EQ(original.getPriceVector(), std::vector<double>({ 10, 20, 30 }));
+
+    original.removePricesLowerThan(15);
+    EXPECT_EQ(copy.getPriceVector(), std::vector<double>({ 10, 20, 30, 40 }));
+}
+
+TEST(TimeSeriesTransformations, moveLeavesSourceEmpty) {
+    TimeSeriesTransformations original({ 1, 2, 3 }, { 10, 20, 30 }, "Moved");
+    const double* data = original.getPriceView().data();
+
+    TimeSeriesTransformations moved = std::move(original);
+    EXPECT_EQ(moved.getPriceView().data(), data);
+    EXPECT_EQ(moved.getName(), "Moved");
+    EXPECT_EQ(original.count(), 0);
+    EXPECT_EQ(original.getName(), "");
+
+    original.addASharePrice(5, 50);
+    TimeSeriesTransformations empty;
+    EXPECT_EQ(empty.count(), 0);
+    EXPECT_EQ(original.count(), 1);
+    EXPECT_EQ(moved.count(), 3);
+}
+
+// Lazy queries.
+TEST(TimeSeriesQuery, matchesChainedFilters) {
+    TimeSeriesTransformations series({ 10, 20, 30, 40, 50, 60 }, { 5, 1, 7, 3, 9, 4 }, "Query");
+
+    TimeSeriesTransformations filtered = series;
+    filtered.removePricesBefore(20);
+    filtered.removePricesAfter(50);
+    filtered.removePricesGreaterThan(7);
+    filtered.removePricesLowerThan(2);
+
+    TimeSeriesQuery query = series.query().after(20).before(50).priceBelow(7).priceAbove(2);
+    EXPECT_EQ(query.count(), 2);
+    EXPECT_TRUE(query.materialize() == filtered);
+    EXPECT_EQ(query.materialize().getName(), "Query");
+
+    double queryMean, filteredMean;
+    EXPECT_TRUE(query.mean(&queryMean));
+    filtered.mean(&filteredMean);
+    EXPECT_DOUBLE_EQ(queryMean, filteredMean);
+    EXPECT_EQ(series.count(), 6);
+
+    EXPECT_EQ(series.query().after(20).count(), 5);
+    EXPECT_FALSE(series.query().priceAbove(100).mean(&queryMean));
+    EXPECT_TRUE(std::isnan(queryMean));
+    EXPECT_THROW(series.query().after("not a date"), std::invalid_argument);
+}
+
+TEST(TimeSeriesQuery, survivesChangesToTheSeries) {
+    std::vector<double> prices(2000);
+    std::vector<int> times(2000);
+    for (int i = 0; i < 2000; i++) {
+        times[i] = i;
+        prices[i] = i % 10;
+    }
+    TimeSeriesTransformations series(times, prices);
+
+    TimeSeriesQuery query = series.query().priceAbove(5);
+    series.removePricesLowerThan(8);
+
+    SummaryStatistics stats;
+    EXPECT_TRUE(query.summary(&stats));
+    EXPECT_EQ(stats.count, 1000);
+    EXPECT_DOUBLE_EQ(stats.mean, 7);
+    EXPECT_EQ(stats.min, 5);
+    EXPECT_EQ(stats.max, 9);
+    EXPECT_EQ(series.count(), 400);
+}
+
+// Concurrent series.
+TEST(ConcurrentTimeSeries, appendsAndQueries) {
+    ConcurrentTimeSeries series(TimeResolution::Seconds, "Live");
+    double value;
+    EXPECT_FALSE(series.mean(&value));
+    EXPECT_FALSE(series.getPriceAtDate(10, &value));
+
+    for (int i = 0; i < 200000; i++) {
+        series.addASharePrice(i / 2, i % 100);
+    }
+    series.addASharePrice("2021-04-22", 7);
+    EXPECT_THROW(series.addASharePrice(5, 1), std::invalid_argument);
+
+    EXPECT_EQ(series.count(), 200001);
+    EXPECT_TRUE(series.getPriceAtDate(70000, &value));
+    EXPECT_EQ(value, 0);
+    EXPECT_TRUE(series.getPriceAtDate("2021-04-22"_unix, &value));
+    EXPECT_EQ(value, 7);
+    EXPECT_FALSE(series.getPriceAtDate(100000, &value));
+
+    TimeSeriesTransformations snapshot = series.snapshot();
+    EXPECT_EQ(snapshot.count(), 200001);
+    EXPECT_EQ(snapshot.getName(), "Live");
+
+    SummaryStatistics live, copied;
+    series.summary(&live);
+    snapshot.summary(&copied);
+    EXPECT_EQ(live.count, copied.count);
+    EXPECT_DOUBLE_EQ(live.mean, copied.mean);
+    EXPECT_EQ(live.max, 99);
+}
+
+TEST(ConcurrentTimeSeries, readersSeeConsistentRowsWhileWriting) {
+    ConcurrentTimeSeries series;
+    const int rows = 300000;
+    std::atomic<bool> consistent = true;
+
+    // Every price equals its time, so any torn row or summary shows up as a mismatch.
+    std::vector<std::thread> readers;
+    for (int reader = 0; reader < 3; reader++) {
+        readers.emplace_back([&] {
+            while (series.count() < rows) {
+                SummaryStatistics stats;
+                if (series.summary(&stats) && stats.max != double(stats.count - 1)) {
+                    consistent = false;
+                }
+
+                double value;
+                int time = static_cast<int>(series.count() / 2);
+                if (series.getPriceAtDate(time, &value) && value != time) {
+                    consistent = false;
+                }
+            }
+            });
+    }
+
+    for (int i = 0; i < rows; i++) {
+        series.addASharePrice(i, i);
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_TRUE(consistent);
+    EXPECT_EQ(series.snapshot().getPriceVector().back(), rows - 1);
+}
+
+// Tick queue.
+TEST(TickQueue, rejectsWhenFullAndDrainsInBatches) {
+    TickQueue queue(3);
+    EXPECT_EQ(queue.capacity(), 4);
+    EXPECT_THROW(TickQueue(0), std::invalid_argument);
+
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(queue.tryPush(10 - i, i));
+    }
+    EXPECT_FALSE(queue.tryPush(20, 4));
+    EXPECT_EQ(queue.size(), 4);
+
+    TimeSeriesTransformations series;
+    EXPECT_EQ(queue.drainInto(series, 3), 3);
+    EXPECT_TRUE(queue.tryPush(20, 4));
+    EXPECT_EQ(queue.drainInto(series), 2);
+    EXPECT_EQ(queue.drainInto(series), 0);
+
+    EXPECT_EQ(series.getTimestampVector(), std::vector<Timestamp>({ 7, 8, 9, 10, 20 }));
+    EXPECT_EQ(series.getPriceVector(), std::vector<double>({ 3, 2, 1, 0, 4 }));
+}
+
+TEST(TickQueue, carriesEveryTickBetweenThreads) {
+    TickQueue queue(256);
+    const int ticks = 200000;
+
+    std::thread producer([&] {
+        for (int i = 0; i < ticks; i++) {
+            while (!queue.tryPush(i, i)) {
+                std::this_thread::yield();
+            }
+        }
+        });
+
+    TimeSeriesTransformations series;
+    while (series.count() < ticks) {
+        if (queue.drainInto(series) == 0) {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    std::vector<double> prices = series.getPriceVector();
+    bool inOrder = true;
+    for (int i = 0; i < ticks; i++) {
+        inOrder = inOrder && prices[i] == i;
+    }
+    EXPECT_EQ(prices.size(), ticks);
+    EXPECT_TRUE(inOrder);
+}
+
+// Chunked series.
+TEST(ChunkedTimeSeries, matchesContiguousSeriesAcrossChunks) {
+    // Two ticks per second over several chunks.
+    const int rows = 3 * ChunkedColumns::chunkRows + 100;
+    ChunkedTimeSeries chunked(TimeResolution::Seconds, "Chunked");
+    std::vector<int> times(rows);
+    std::vector<double> prices(rows);
+    for (int i = 0; i < rows; i++) {
+        times[i] = i / 2;
+        prices[i] = (i * 7919) % 1000;
+        chunked.addASharePrice(times[i], prices[i]);
+    }
+    TimeSeriesTransformations series(times, prices, "Chunked");
+
+    EXPECT_EQ(chunked.count(), rows);
+    EXPECT_TRUE(chunked.toSeries() == series);
+    EXPECT_EQ(chunked.toSeries().getName(), "Chunked");
+
+    SummaryStatistics chunkedStats, seriesStats;
+    chunked.summary(&chunkedStats);
+    series.summary(&seriesStats);
+    EXPECT_EQ(chunkedStats.count, seriesStats.count);
+    EXPECT_NEAR(chunkedStats.mean, seriesStats.mean, 1e-9);
+
+    // A range straddling two chunk boundaries.
+    int start = ChunkedColumns::chunkRows / 2 - 10;
+    int end = ChunkedColumns::chunkRows + 5;
+    EXPECT_TRUE(chunked.summaryBetween(start, end, &chunkedStats));
+    seriesStats = summarize(series.sliceBetween(start, end).getPriceView());
+    EXPECT_EQ(chunkedStats.count, seriesStats.count);
+    EXPECT_NEAR(chunkedStats.mean, seriesStats.mean, 1e-9);
+    EXPECT_EQ(chunkedStats.max, seriesStats.max);
+
+    std::vector<TimePriceView> views = chunked.viewsBetween(start, end);
+    EXPECT_EQ(views.size(), 3);
+    EXPECT_EQ(views.front()[0], std::make_pair(Timestamp(start), prices[start * 2]));
+
+    double value;
+    EXPECT_TRUE(chunked.getPriceAtDate(ChunkedColumns::chunkRows / 2, &value));
+    EXPECT_EQ(value, prices[ChunkedColumns::chunkRows]);
+    EXPECT_FALSE(chunked.getPriceAtDate(rows, &value));
+    EXPECT_FALSE(chunked.summaryBetween(rows, rows + 10, &chunkedStats));
+}
+
+TEST(ChunkedTimeSeries, rejectsOutOfOrderTicks) {
+    ChunkedTimeSeries chunked;
+    chunked.addTicks({ 1, 2, 2, 5 }, { 1, 2, 3, 4 });
+    EXPECT_THROW(chunked.addTick(4, 1), std::invalid_argument);
+    EXPECT_THROW(chunked.addTicks({ 6, 5 }, { 1, 1 }), std::invalid_argument);
+    EXPECT_THROW(chunked.addTicks({ 6 }, { 1, 1 }), std::runtime_error);
+    chunked.addTick(5, 5);
+
+    double meanValue;
+    EXPECT_TRUE(chunked.mean(&meanValue));
+    EXPECT_DOUBLE_EQ(meanValue, 3);
+    EXPECT_EQ(chunked.count(), 5);
+}
+
+TEST(ChunkedTimeSeries, moveLeavesSourceEmpty) {
+    ChunkedTimeSeries source(TimeResolution::Seconds, "Moved");
+    source.addTicks({ 1, 2 }, { 1, 2 });
+
+    ChunkedTimeSeries moved = std::move(source);
+    EXPECT_EQ(moved.count(), 2);
+    EXPECT_EQ(moved.getName(), "Moved");
+    EXPECT_EQ(source.count(), 0);
+    double meanValue;
+    EXPECT_FALSE(source.mean(&meanValue));
+    EXPECT_EQ(source.viewsBetween(0, 10).size(), 0);
+
+    source.addTick(5, 5);
+    EXPECT_TRUE(source.getPriceAtDate(5, &meanValue));
+    EXPECT_EQ(source.count(), 1);
+
+    moved = std::move(source);
+    EXPECT_EQ(moved.count(), 1);
+    EXPECT_EQ(source.count(), 0);
+    source.addTick(1, 1);
+    EXPECT_EQ(source.count(), 1);
+}
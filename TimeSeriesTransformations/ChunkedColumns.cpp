@@ -0,0 +1,120 @@
+// ChunkedColumns.cpp : Append only chunked time and price columns.
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include "ChunkedColumns.h"
+
+ChunkedColumns::ChunkedColumns() : chunks(std::make_unique<std::unique_ptr<Chunk>[]>(maxChunks)) { }
+
+ChunkedColumns::ChunkedColumns(ChunkedColumns&& other) noexcept : chunks(std::move(other.chunks)), rows(std::exchange(other.rows, 0)) { }
+
+ChunkedColumns& ChunkedColumns::operator=(ChunkedColumns&& other) noexcept {
+	if (this != &other) {
+		chunks = std::move(other.chunks);
+		rows = std::exchange(other.rows, 0);
+	}
+
+	return *this;
+}
+
+void ChunkedColumns::append(Timestamp time, double price) {
+	size_t chunk = rows >> chunkShift;
+	if (chunk == maxChunks) {
+		throw std::overflow_error("Chunked columns are full.");
+	}
+
+	if (!chunks) {
+		chunks = std::make_unique<std::unique_ptr<Chunk>[]>(maxChunks);
+	}
+
+	// Chunks are not value initialised, every row is written before it is counted.
+	if (!chunks[chunk]) {
+		chunks[chunk] = std::make_unique_for_overwrite<Chunk>();
+	}
+
+	chunks[chunk]->times[rows & (chunkRows - 1)] = time;
+	chunks[chunk]->prices[rows & (chunkRows - 1)] = price;
+	rows++;
+}
+
+size_t ChunkedColumns::size() const noexcept {
+	return rows;
+}
+
+Timestamp ChunkedColumns::timeAt(size_t row) const noexcept {
+	return chunks[row >> chunkShift]->times[row & (chunkRows - 1)];
+}
+
+double ChunkedColumns::priceAt(size_t row) const noexcept {
+	return chunks[row >> chunkShift]->prices[row & (chunkRows - 1)];
+}
+
+TimePriceView ChunkedColumns::run(size_t first, size_t last) const noexcept {
+	const Chunk& chunk = *chunks[first >> chunkShift];
+	size_t offset = first & (chunkRows - 1);
+	size_t count = std::min(last - first, chunkRows - offset);
+
+	return TimePriceView(std::span<const Timestamp>(chunk.times + offset, count), std::span<const double>(chunk.prices + offset, count));
+}
+
+std::vector<TimePriceView> ChunkedColumns::runs(size_t first, size_t last) const {
+	std::vector<TimePriceView> result;
+	while (first < last) {
+		result.push_back(run(first, last));
+		first += result.back().size();
+	}
+
+	return result;
+}
+
+size_t ChunkedColumns::lowerBound(Timestamp time, size_t rowCount) const noexcept {
+	if (rowCount == 0) {
+		return 0;
+	}
+
+	// The last chunk whose first time is before time is the only one that can hold the answer.
+	size_t chunkCount = ((rowCount - 1) >> chunkShift) + 1;
+	size_t first = 0;
+	size_t length = chunkCount;
+	while (length > 0) {
+		size_t half = length / 2;
+		if (chunks[first + half]->times[0] < time) {
+			first += half + 1;
+			length -= half + 1;
+		}
+		else {
+			length = half;
+		}
+	}
+
+	if (first == 0) {
+		return 0;
+	}
+
+	size_t chunkStart = (first - 1) << chunkShift;
+	std::span<const Timestamp> times = run(chunkStart, rowCount).getTimeView();
+	return chunkStart + (std::lower_bound(times.begin(), times.end(), time) - times.begin());
+}
+
+SummaryStatistics ChunkedColumns::summarize(size_t first, size_t last) const noexcept {
+	SummaryStatistics total;
+	while (first < last) {
+		std::span<const double> prices = run(first, last).getPriceView();
+		total = mergeSummaries(total, ::summarize(prices));
+		first += prices.size();
+	}
+
+	return total;
+}
+
+void ChunkedColumns::copyRows(size_t first, size_t last, std::vector<Timestamp>* times, std::vector<double>* prices) const {
+	times->reserve(times->size() + (last - first));
+	prices->reserve(prices->size() + (last - first));
+
+	while (first < last) {
+		TimePriceView rowRun = run(first, last);
+		times->insert(times->end(), rowRun.getTimeView().begin(), rowRun.getTimeView().end());
+		prices->insert(prices->end(), rowRun.getPriceView().begin(), rowRun.getPriceView().end());
+		first += rowRun.size();
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include "TimeSeriesTransformations.h"
+
+// Append only time and price columns stored in fixed size chunks listed in a chunk directory. Rows never
+// move once written, so an append is O(1) with no reallocation copy and no transient doubling of memory,
+// and pointers and views into written rows stay valid. Within a chunk the rows are contiguous, so range
+// work runs over a handful of dense spans (runs) that the vectorised kernels handle as usual.
+// Times must be appended in order.
+class ChunkedColumns {
+public:
+	static const size_t chunkShift = 16;
+	static const size_t chunkRows = size_t(1) << chunkShift;
+	static const size_t maxChunks = size_t(1) << 14;
+	static const size_t maxRows = maxChunks << chunkShift;
+
+private:
+	struct Chunk {
+		Timestamp times[chunkRows];
+		double prices[chunkRows];
+	};
+
+	// The directory is allocated once at full size, so appending never moves it either and a row
+	// written before a reader learns of it (see ConcurrentTimeSeries) can be read without locking.
+	// A moved from instance has no directory until its next append.
+	std::unique_ptr<std::unique_ptr<Chunk>[]> chunks;
+	size_t rows = 0;
+
+public:
+	ChunkedColumns();
+	// Moves leave the source empty, copies would duplicate every chunk and are not provided.
+	ChunkedColumns(ChunkedColumns&& other) noexcept;
+	ChunkedColumns& operator=(ChunkedColumns&& other) noexcept;
+
+	// Throws std::overflow_error once every chunk is full.
+	void append(Timestamp time, double price);
+	// Rows appended so far, read by the appending thread only.
+	size_t size() const noexcept;
+
+	Timestamp timeAt(size_t row) const noexcept;
+	double priceAt(size_t row) const noexcept;
+
+	// The contiguous rows from first up to last or the end of first's chunk, whichever comes first.
+	TimePriceView run(size_t first, size_t last) const noexcept;
+	// Every run covering the rows [first, last).
+	std::vector<TimePriceView> runs(size_t first, size_t last) const;
+
+	// The first row in [0, rowCount) whose time is not less than time, or rowCount if there is none.
+	// Binary searches the chunk first times, then within the one chunk that can hold the row.
+	size_t lowerBound(Timestamp time, size_t rowCount) const noexcept;
+
+	// Summary of the prices of rows [first, last), run by run.
+	SummaryStatistics summarize(size_t first, size_t last) const noexcept;
+	// Append the rows [first, last) to the given columns.
+	void copyRows(size_t first, size_t last, std::vector<Timestamp>* times, std::vector<double>* prices) const;
+};
@@ -0,0 +1,138 @@
+// ChunkedTimeSeries.cpp : Append only series over chunked columns.
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include "ChunkedTimeSeries.h"
+
+ChunkedTimeSeries::ChunkedTimeSeries(TimeResolution resolution, const std::string& name) : resolution(resolution), name(name) { }
+
+ChunkedTimeSeries::ChunkedTimeSeries(ChunkedTimeSeries&& other) noexcept
+	: columns(std::move(other.columns)), priceAggregates(std::exchange(other.priceAggregates, SummaryStatistics())),
+	resolution(other.resolution), name(std::move(other.name)) {
+	other.name.clear();
+}
+
+ChunkedTimeSeries& ChunkedTimeSeries::operator=(ChunkedTimeSeries&& other) noexcept {
+	if (this == &other) {
+		return *this;
+	}
+
+	columns = std::move(other.columns);
+	priceAggregates = std::exchange(other.priceAggregates, SummaryStatistics());
+	resolution = other.resolution;
+	name = std::move(other.name);
+	other.name.clear();
+
+	return *this;
+}
+
+void ChunkedTimeSeries::addTick(Timestamp time, double price) {
+	if (columns.size() != 0 && time < columns.timeAt(columns.size() - 1)) {
+		throw std::invalid_argument("Ticks must be appended in time order.");
+	}
+
+	columns.append(time, price);
+	accumulate(&priceAggregates, price);
+}
+
+// The whole batch is checked before any of it is appended.
+void ChunkedTimeSeries::addTicks(const std::vector<Timestamp>& timeVec, const std::vector<double>& priceVec) {
+	if (timeVec.size() != priceVec.size()) {
+		throw std::runtime_error("Price and time vectors are not equally sized.");
+	}
+
+	if (timeVec.empty()) { return; }
+
+	bool inOrder = std::is_sorted(timeVec.begin(), timeVec.end());
+	if (!inOrder || (columns.size() != 0 && timeVec.front() < columns.timeAt(columns.size() - 1))) {
+		throw std::invalid_argument("Ticks must be appended in time order.");
+	}
+
+	if (timeVec.size() > ChunkedColumns::maxRows - columns.size()) {
+		throw std::overflow_error("Chunked columns are full.");
+	}
+
+	for (size_t i = 0; i < timeVec.size(); i++) {
+		columns.append(timeVec[i], priceVec[i]);
+	}
+	priceAggregates = mergeSummaries(priceAggregates, summarize(priceVec));
+}
+
+void ChunkedTimeSeries::addASharePrice(Timestamp unixEpochTime, double price) {
+	addTick(unixEpochTime * ticksPerSecond(resolution), price);
+}
+
+void ChunkedTimeSeries::addASharePrice(const std::string& date, double price) {
+	Timestamp unixEpochTime;
+	if (!parseDateTime(date, &unixEpochTime)) {
+		throw std::invalid_argument("Date " + date + " cannot be parsed.");
+	}
+
+	addASharePrice(unixEpochTime, price);
+}
+
+size_t ChunkedTimeSeries::count() const noexcept {
+	return columns.size();
+}
+
+bool ChunkedTimeSeries::summary(SummaryStatistics* stats) const noexcept {
+	*stats = priceAggregates;
+	return priceAggregates.count != 0;
+}
+
+bool ChunkedTimeSeries::mean(double* meanValue) const noexcept {
+	*meanValue = priceAggregates.mean;
+	return priceAggregates.count != 0;
+}
+
+bool ChunkedTimeSeries::standardDeviation(double* standardDeviationValue) const noexcept {
+	*standardDeviationValue = std::sqrt(priceAggregates.variance);
+	return priceAggregates.count != 0;
+}
+
+std::pair<size_t, size_t> ChunkedTimeSeries::rowsInSeconds(Timestamp firstSecond, Timestamp lastSecond) const noexcept {
+	const Timestamp ticks = ticksPerSecond(resolution);
+	size_t first = columns.lowerBound(firstSecond * ticks, columns.size());
+	size_t last = columns.lowerBound((lastSecond + 1) * ticks, columns.size());
+	return { first, std::max(first, last) };
+}
+
+bool ChunkedTimeSeries::summaryBetween(Timestamp startTime, Timestamp endTime, SummaryStatistics* stats) const noexcept {
+	std::pair<size_t, size_t> rows = rowsInSeconds(startTime, endTime);
+	*stats = columns.summarize(rows.first, rows.second);
+	return stats->count != 0;
+}
+
+bool ChunkedTimeSeries::getPriceAtDate(Timestamp unixEpochTime, double* value) const noexcept {
+	std::pair<size_t, size_t> matches = rowsInSeconds(unixEpochTime, unixEpochTime);
+	if (matches.first != matches.second) {
+		*value = columns.priceAt(matches.first);
+		return true;
+	}
+
+	*value = std::numeric_limits<double>::quiet_NaN();
+	return false;
+}
+
+std::vector<TimePriceView> ChunkedTimeSeries::viewsBetween(Timestamp startTime, Timestamp endTime) const {
+	std::pair<size_t, size_t> rows = rowsInSeconds(startTime, endTime);
+	return columns.runs(rows.first, rows.second);
+}
+
+TimeSeriesTransformations ChunkedTimeSeries::toSeries() const {
+	std::vector<Timestamp> times;
+	std::vector<double> prices;
+	columns.copyRows(0, columns.size(), &times, &prices);
+
+	return TimeSeriesTransformations(resolution, times, prices, name);
+}
+
+TimeResolution ChunkedTimeSeries::getResolution() const noexcept {
+	return resolution;
+}
+
+std::string ChunkedTimeSeries::getName() const {
+	return name;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "TimeSeriesTransformations.h"
+#include "ChunkedColumns.h"
+
+// Append only series for long running feeds, stored in ChunkedColumns rather than two growing vectors.
+// An append never relocates earlier rows, so there are no copy stalls or transient 2x memory as the
+// series grows, while whole series and time range statistics still run over dense per chunk spans.
+// Times must be appended in order.
+class ChunkedTimeSeries {
+	ChunkedColumns columns;
+	// Kept current on every append.
+	SummaryStatistics priceAggregates;
+
+	TimeResolution resolution = TimeResolution::Seconds;
+	std::string name;
+
+	// Rows whose ticks fall in the seconds firstSecond to lastSecond inclusive.
+	std::pair<size_t, size_t> rowsInSeconds(Timestamp firstSecond, Timestamp lastSecond) const noexcept;
+
+public:
+	explicit ChunkedTimeSeries(TimeResolution resolution = TimeResolution::Seconds, const std::string& name = "");
+	// Moves leave the source an empty series, copies are not provided.
+	ChunkedTimeSeries(ChunkedTimeSeries&& other) noexcept;
+	ChunkedTimeSeries& operator=(ChunkedTimeSeries&& other) noexcept;
+
+	// Throw std::invalid_argument for a time before the last one appended, std::runtime_error for
+	// unequally sized vectors and std::overflow_error if the ticks do not fit. Nothing is appended
+	// when they throw.
+	void addTick(Timestamp time, double price);
+	void addTicks(const std::vector<Timestamp>& timeVec, const std::vector<double>& priceVec);
+	void addASharePrice(Timestamp unixEpochTime, double price);
+	void addASharePrice(const std::string& date, double price);
+
+	size_t count() const noexcept;
+	bool summary(SummaryStatistics* stats) const noexcept;
+	bool mean(double* meanValue) const noexcept;
+	bool standardDeviation(double* standardDeviationValue) const noexcept;
+	// Summary of the prices from startTime to endTime inclusive, every tick of both seconds included.
+	bool summaryBetween(Timestamp startTime, Timestamp endTime, SummaryStatistics* stats) const noexcept;
+	bool getPriceAtDate(Timestamp unixEpochTime, double* value) const noexcept;
+
+	// The rows from startTime to endTime as contiguous per chunk views, valid while the series lives.
+	std::vector<TimePriceView> viewsBetween(Timestamp startTime, Timestamp endTime) const;
+	// Copy into an ordinary series, for the analyses that need one contiguous column.
+	TimeSeriesTransformations toSeries() const;
+
+	TimeResolution getResolution() const noexcept;
+	std::string getName() const;
+};
@@ -0,0 +1,131 @@
+// ConcurrentTimeSeries.cpp : Lock free single writer, many reader time series.
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "ConcurrentTimeSeries.h"
+
+ConcurrentTimeSeries::ConcurrentTimeSeries(TimeResolution resolution, const std::string& name)
+	: resolution(resolution), name(name) {
+	publishSummary();
+}
+
+void ConcurrentTimeSeries::addTick(Timestamp time, double price) {
+	size_t row = publishedCount.load(std::memory_order_relaxed);
+	if (row != 0 && time < lastTime) {
+		throw std::invalid_argument("Ticks must be appended in time order.");
+	}
+
+	columns.append(time, price);
+	lastTime = time;
+	publishedCount.store(row + 1, std::memory_order_release);
+
+	accumulate(&writerSummary, price);
+	publishSummary();
+}
+
+void ConcurrentTimeSeries::addASharePrice(Timestamp unixEpochTime, double price) {
+	addTick(unixEpochTime * ticksPerSecond(resolution), price);
+}
+
+void ConcurrentTimeSeries::addASharePrice(const std::string& date, double price) {
+	Timestamp unixEpochTime;
+	if (!parseDateTime(date, &unixEpochTime)) {
+		throw std::invalid_argument("Date " + date + " cannot be parsed.");
+	}
+
+	addASharePrice(unixEpochTime, price);
+}
+
+// Seqlock write: the odd sequence marks the fields as changing, the release fence keeps the field
+// stores after it and the final release store keeps them before the even sequence.
+void ConcurrentTimeSeries::publishSummary() noexcept {
+	unsigned int sequence = summarySequence.load(std::memory_order_relaxed);
+	summarySequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	summaryCount.store(writerSummary.count, std::memory_order_relaxed);
+	summarySum.store(writerSummary.sum, std::memory_order_relaxed);
+	summaryMean.store(writerSummary.mean, std::memory_order_relaxed);
+	summaryVariance.store(writerSummary.variance, std::memory_order_relaxed);
+	summarySumOfSquaredDeviations.store(writerSummary.sumOfSquaredDeviations, std::memory_order_relaxed);
+	summaryMin.store(writerSummary.min, std::memory_order_relaxed);
+	summaryMax.store(writerSummary.max, std::memory_order_relaxed);
+
+	summarySequence.store(sequence + 2, std::memory_order_release);
+}
+
+size_t ConcurrentTimeSeries::count() const noexcept {
+	return publishedCount.load(std::memory_order_acquire);
+}
+
+// Seqlock read, retried if the writer was publishing while the fields were read.
+bool ConcurrentTimeSeries::summary(SummaryStatistics* stats) const noexcept {
+	unsigned int before;
+	unsigned int after;
+
+	do {
+		before = summarySequence.load(std::memory_order_acquire);
+
+		stats->count = summaryCount.load(std::memory_order_relaxed);
+		stats->sum = summarySum.load(std::memory_order_relaxed);
+		stats->mean = summaryMean.load(std::memory_order_relaxed);
+		stats->variance = summaryVariance.load(std::memory_order_relaxed);
+		stats->sumOfSquaredDeviations = summarySumOfSquaredDeviations.load(std::memory_order_relaxed);
+		stats->min = summaryMin.load(std::memory_order_relaxed);
+		stats->max = summaryMax.load(std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		after = summarySequence.load(std::memory_order_relaxed);
+	} while ((before & 1) != 0 || before != after);
+
+	return stats->count != 0;
+}
+
+bool ConcurrentTimeSeries::mean(double* meanValue) const noexcept {
+	SummaryStatistics stats;
+	bool hasData = summary(&stats);
+
+	*meanValue = stats.mean;
+	return hasData;
+}
+
+bool ConcurrentTimeSeries::standardDeviation(double* standardDeviationValue) const noexcept {
+	SummaryStatistics stats;
+	bool hasData = summary(&stats);
+
+	*standardDeviationValue = std::sqrt(stats.variance);
+	return hasData;
+}
+
+bool ConcurrentTimeSeries::getPriceAtDate(Timestamp unixEpochTime, double* value) const noexcept {
+	const Timestamp ticks = ticksPerSecond(resolution);
+	const Timestamp firstTick = unixEpochTime * ticks;
+	size_t rows = count();
+	size_t first = columns.lowerBound(firstTick, rows);
+
+	if (first < rows && columns.timeAt(first) < firstTick + ticks) {
+		*value = columns.priceAt(first);
+		return true;
+	}
+
+	*value = std::numeric_limits<double>::quiet_NaN();
+	return false;
+}
+
+TimeSeriesTransformations ConcurrentTimeSeries::snapshot() const {
+	std::vector<Timestamp> times;
+	std::vector<double> prices;
+	columns.copyRows(0, count(), &times, &prices);
+
+	return TimeSeriesTransformations(resolution, times, prices, name);
+}
+
+TimeResolution ConcurrentTimeSeries::getResolution() const noexcept {
+	return resolution;
+}
+
+std::string ConcurrentTimeSeries::getName() const {
+	return name;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <string>
+#include <cstddef>
+#include "TimeSeriesTransformations.h"
+#include "ChunkedColumns.h"
+
+// A series for one writer thread appending ticks while any number of reader threads query it, without
+// locks. Rows live in ChunkedColumns, whose chunks never move once allocated, and the writer publishes each
+// append by a release store of the row count, so a reader sees every row below the count it loaded
+// fully written and never waits on the writer. The running summary is published through a seqlock:
+// readers retry only while an append is publishing it, and the writer never waits on them.
+// Times must be appended in order, the chunks are never sorted.
+class ConcurrentTimeSeries {
+	// Rows below publishedCount were written before it was stored, so readers may use them freely.
+	ChunkedColumns columns;
+	std::atomic<size_t> publishedCount{ 0 };
+
+	// The summary of the published rows, guarded by summarySequence (odd while being written).
+	std::atomic<unsigned int> summarySequence{ 0 };
+	std::atomic<size_t> summaryCount{ 0 };
+	std::atomic<double> summarySum{ 0.0 };
+	std::atomic<double> summaryMean;
+	std::atomic<double> summaryVariance;
+	std::atomic<double> summarySumOfSquaredDeviations{ 0.0 };
+	std::atomic<double> summaryMin;
+	std::atomic<double> summaryMax;
+
+	// Writer only state.
+	SummaryStatistics writerSummary;
+	Timestamp lastTime = 0;
+
+	TimeResolution resolution = TimeResolution::Seconds;
+	std::string name;
+
+	void publishSummary() noexcept;
+
+public:
+	explicit ConcurrentTimeSeries(TimeResolution resolution = TimeResolution::Seconds, const std::string& name = "");
+	ConcurrentTimeSeries(const ConcurrentTimeSeries&) = delete;
+	ConcurrentTimeSeries& operator=(const ConcurrentTimeSeries&) = delete;
+
+	// Writer thread only. Throws std::invalid_argument for a time before the last one appended and
+	// std::overflow_error once every chunk is full.
+	void addTick(Timestamp time, double price);
+	void addASharePrice(Timestamp unixEpochTime, double price);
+	void addASharePrice(const std::string& date, double price);
+
+	// Safe from any thread, each sees the rows published when it started.
+	size_t count() const noexcept;
+	bool summary(SummaryStatistics* stats) const noexcept;
+	bool mean(double* meanValue) const noexcept;
+	bool standardDeviation(double* standardDeviationValue) const noexcept;
+	// The first tick within the second unixEpochTime, like TimeSeriesTransformations::getPriceAtDate.
+	bool getPriceAtDate(Timestamp unixEpochTime, double* value) const noexcept;
+	// Copy of the published rows as an ordinary series.
+	TimeSeriesTransformations snapshot() const;
+
+	TimeResolution getResolution() const noexcept;
+	std::string getName() const;
+};
@@ -0,0 +1,32 @@
+// DateTime.cpp : UTC date formatting, the constexpr parsing lives in the header.
+#include "DateTime.h"
+
+std::string formatDateTime(Timestamp unixEpoch) {
+	std::int64_t days = unixEpoch / secondsPerDay;
+	std::int64_t secondOfDay = unixEpoch % secondsPerDay;
+	if (secondOfDay < 0) {
+		secondOfDay += secondsPerDay;
+		days--;
+	}
+
+	std::int64_t year;
+	unsigned int month, day;
+	civilFromDays(days, &year, &month, &day);
+
+	unsigned int fields[6] = { static_cast<unsigned int>(year), month, day, static_cast<unsigned int>(secondOfDay / 3600),
+		static_cast<unsigned int>(secondOfDay / 60 % 60), static_cast<unsigned int>(secondOfDay % 60) };
+
+	std::string text = "0000-00-00 00:00:00";
+	const size_t fieldEnds[6] = { 4, 7, 10, 13, 16, 19 };
+	const size_t fieldWidths[6] = { 4, 2, 2, 2, 2, 2 };
+
+	for (size_t field = 0; field < 6; field++) {
+		unsigned int value = fields[field];
+		for (size_t i = 0; i < fieldWidths[field]; i++) {
+			text[fieldEnds[field] - 1 - i] = static_cast<char>('0' + value % 10);
+			value /= 10;
+		}
+	}
+
+	return text;
+}
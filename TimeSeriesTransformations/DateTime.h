@@ -0,0 +1,125 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Calendar arithmetic on the proleptic Gregorian calendar in UTC. Everything except formatting is
+// constexpr, so constant dates can be converted to timestamps at compile time.
+
+constexpr std::int64_t secondsPerDay = 86400;
+
+// Series timestamps are 64 bit counts of ticks since the unix epoch, the tick length is the series resolution.
+using Timestamp = std::int64_t;
+
+enum class TimeResolution : char {
+	Seconds = 0,
+	Milliseconds = 1,
+	Microseconds = 2,
+	Nanoseconds = 3
+};
+
+constexpr Timestamp ticksPerSecond(TimeResolution resolution) noexcept {
+	switch (resolution) {
+	case TimeResolution::Milliseconds: return 1000;
+	case TimeResolution::Microseconds: return 1000000;
+	case TimeResolution::Nanoseconds: return 1000000000;
+	default: return 1;
+	}
+}
+
+constexpr bool isLeapYear(std::int64_t year) noexcept {
+	return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+constexpr unsigned int daysInMonth(std::int64_t year, unsigned int month) noexcept {
+	constexpr unsigned int days[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+	return (month == 2 && isLeapYear(year)) ? 29 : days[month - 1];
+}
+
+// Days since 1970-01-01 (Howard Hinnant's days_from_civil).
+constexpr std::int64_t daysFromCivil(std::int64_t year, unsigned int month, unsigned int day) noexcept {
+	year -= month <= 2;
+	const std::int64_t era = (year >= 0 ? year : year - 399) / 400;
+	const unsigned int yearOfEra = static_cast<unsigned int>(year - era * 400);
+	const unsigned int dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+	const unsigned int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+	return era * 146097 + static_cast<std::int64_t>(dayOfEra) - 719468;
+}
+
+// Inverse of daysFromCivil.
+constexpr void civilFromDays(std::int64_t days, std::int64_t* year, unsigned int* month, unsigned int* day) noexcept {
+	days += 719468;
+	const std::int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+	const unsigned int dayOfEra = static_cast<unsigned int>(days - era * 146097);
+	const unsigned int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+	const unsigned int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+	const unsigned int shiftedMonth = (5 * dayOfYear + 2) / 153;
+
+	*day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+	*month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+	*year = static_cast<std::int64_t>(yearOfEra) + era * 400 + (*month <= 2);
+}
+
+// Read exactly count digits starting at text[offset].
+constexpr bool readDigits(std::string_view text, size_t offset, size_t count, unsigned int* value) noexcept {
+	unsigned int result = 0;
+
+	for (size_t i = offset; i < offset + count; i++) {
+		if (text[i] < '0' || text[i] > '9') {
+			return false;
+		}
+		result = result * 10 + static_cast<unsigned int>(text[i] - '0');
+	}
+
+	*value = result;
+	return true;
+}
+
+// Parse "YYYY-MM-DD" or "YYYY-MM-DD HH:MM:SS" as UTC into 64 bit seconds since the unix epoch, so every
+// four digit year is representable. Returns false for any other layout, impossible dates such as
+// 1970-02-31 and out of range times of day.
+constexpr bool parseDateTime(std::string_view text, Timestamp* unixEpoch) noexcept {
+	if (text.size() != 10 && text.size() != 19) {
+		return false;
+	}
+
+	unsigned int year = 0, month = 0, day = 0;
+	unsigned int hour = 0, minute = 0, second = 0;
+
+	if (!readDigits(text, 0, 4, &year) || text[4] != '-' || !readDigits(text, 5, 2, &month) || text[7] != '-' || !readDigits(text, 8, 2, &day)) {
+		return false;
+	}
+
+	if (text.size() == 19) {
+		if (text[10] != ' ' || !readDigits(text, 11, 2, &hour) || text[13] != ':' || !readDigits(text, 14, 2, &minute) || text[16] != ':' || !readDigits(text, 17, 2, &second)) {
+			return false;
+		}
+	}
+
+	if (month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month) || hour > 23 || minute > 59 || second > 59) {
+		return false;
+	}
+
+	*unixEpoch = daysFromCivil(year, month, day) * secondsPerDay + hour * 3600 + minute * 60 + second;
+	return true;
+}
+
+// Convert a constant date at compile time, e.g. series.removePricesBefore(unixTime("2021-04-22")).
+// An invalid date is a compile error.
+consteval Timestamp unixTime(std::string_view text) {
+	Timestamp unixEpoch = 0;
+	if (!parseDateTime(text, &unixEpoch)) {
+		throw std::invalid_argument("Date cannot be parsed.");
+	}
+	return unixEpoch;
+}
+
+// Literal form of unixTime, e.g. series.getPriceAtDate("2021-04-22 09:30:00"_unix, &price).
+consteval Timestamp operator""_unix(const char* text, size_t length) {
+	return unixTime(std::string_view(text, length));
+}
+
+// Format seconds since the unix epoch as "YYYY-MM-DD HH:MM:SS" in UTC.
+std::string formatDateTime(Timestamp unixEpoch);
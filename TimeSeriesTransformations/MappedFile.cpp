@@ -0,0 +1,84 @@
+// MappedFile.cpp : Read only file mappings for the loaders.
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& filenameAndPath) {
+	HANDLE file = CreateFileA(filenameAndPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) { return; }
+	fileHandle = file;
+
+	LARGE_INTEGER fileSize;
+	// Only regular disk files can be mapped, pipes are left to the stream reader.
+	if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) { return; }
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) { return; }
+	mappingHandle = mapping;
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr) { return; }
+
+	mappedData = static_cast<const char*>(view);
+	mappedSize = static_cast<size_t>(fileSize.QuadPart);
+}
+
+MappedFile::~MappedFile() {
+	if (mappedData) { UnmapViewOfFile(mappedData); }
+	if (mappingHandle) { CloseHandle(mappingHandle); }
+	if (fileHandle) { CloseHandle(fileHandle); }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filenameAndPath) {
+	int fileDescriptor = open(filenameAndPath.c_str(), O_RDONLY);
+	if (fileDescriptor < 0) { return; }
+
+	struct stat fileStatus;
+	// Only regular files can be mapped, pipes are left to the stream reader.
+	if (fstat(fileDescriptor, &fileStatus) != 0 || !S_ISREG(fileStatus.st_mode) || fileStatus.st_size == 0) {
+		close(fileDescriptor);
+		return;
+	}
+
+	// A shared read only mapping lets every process loading the same file use the same page cache.
+	void* view = mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_SHARED, fileDescriptor, 0);
+	close(fileDescriptor);
+
+	if (view == MAP_FAILED) { return; }
+
+	madvise(view, static_cast<size_t>(fileStatus.st_size), MADV_SEQUENTIAL);
+
+	mappedData = static_cast<const char*>(view);
+	mappedSize = static_cast<size_t>(fileStatus.st_size);
+}
+
+MappedFile::~MappedFile() {
+	if (mappedData) { munmap(const_cast<char*>(mappedData), mappedSize); }
+}
+
+#endif
+
+bool MappedFile::isMapped() const noexcept {
+	return mappedData != nullptr;
+}
+
+const char* MappedFile::data() const noexcept {
+	return mappedData;
+}
+
+size_t MappedFile::size() const noexcept {
+	return mappedSize;
+}
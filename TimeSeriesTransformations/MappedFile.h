@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+#include <cstddef>
+
+// Read only memory mapping of an entire file. Pipes, empty files and anything else that cannot
+// be mapped leave the object unmapped, callers should then fall back to reading a stream.
+class MappedFile {
+	const char* mappedData = nullptr;
+	size_t mappedSize = 0;
+
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+
+public:
+	explicit MappedFile(const std::string& filenameAndPath);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool isMapped() const noexcept;
+	const char* data() const noexcept;
+	size_t size() const noexcept;
+};
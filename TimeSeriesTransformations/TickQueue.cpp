@@ -0,0 +1,60 @@
+// TickQueue.cpp : Single producer, single consumer tick ring buffer.
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include "TickQueue.h"
+
+TickQueue::TickQueue(size_t capacity) {
+	if (capacity == 0) {
+		throw std::invalid_argument("Tick queue capacity must be positive.");
+	}
+
+	capacity = std::bit_ceil(capacity);
+	ticks = std::make_unique<Tick[]>(capacity);
+	mask = capacity - 1;
+}
+
+bool TickQueue::tryPush(Timestamp time, double price) noexcept {
+	size_t position = tail.load(std::memory_order_relaxed);
+
+	if (position - producerCachedHead > mask) {
+		producerCachedHead = head.load(std::memory_order_acquire);
+		if (position - producerCachedHead > mask) {
+			return false;
+		}
+	}
+
+	ticks[position & mask] = { time, price };
+	tail.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+size_t TickQueue::drainInto(TimeSeriesTransformations& series, size_t maxTicks) {
+	size_t position = head.load(std::memory_order_relaxed);
+	size_t drained = std::min(tail.load(std::memory_order_acquire) - position, maxTicks);
+	if (drained == 0) {
+		return 0;
+	}
+
+	batchTimes.clear();
+	batchPrices.clear();
+	for (size_t i = position; i < position + drained; i++) {
+		batchTimes.push_back(ticks[i & mask].time);
+		batchPrices.push_back(ticks[i & mask].price);
+	}
+
+	// The slots are handed back before the series work so the producer is not held up by it.
+	head.store(position + drained, std::memory_order_release);
+	series.addTicks(batchTimes, batchPrices);
+
+	return drained;
+}
+
+size_t TickQueue::capacity() const noexcept {
+	return mask + 1;
+}
+
+size_t TickQueue::size() const noexcept {
+	size_t first = head.load(std::memory_order_acquire);
+	return tail.load(std::memory_order_acquire) - first;
+}
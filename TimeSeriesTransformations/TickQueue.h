@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <limits>
+#include <vector>
+#include <cstddef>
+#include "TimeSeriesTransformations.h"
+
+// Bounded lock free queue of ticks between exactly one producer thread, which pushes, and one consumer
+// thread, which drains. Pushing never blocks or allocates, a full queue just rejects the tick. The
+// consumer drains in batches through addTicks, so the series sorts and merges once per batch rather
+// than once per tick.
+class TickQueue {
+	static const size_t cacheLineSize = 64;
+
+	struct Tick {
+		Timestamp time;
+		double price;
+	};
+
+	std::unique_ptr<Tick[]> ticks;
+	size_t mask = 0;
+
+	// head is the next tick to drain and tail the next free slot, both only ever increase. The producer
+	// caches head and only reloads it when the queue looks full, and the indices sit on separate cache
+	// lines so the two threads do not contend for one.
+	alignas(cacheLineSize) std::atomic<size_t> head{ 0 };
+	alignas(cacheLineSize) std::atomic<size_t> tail{ 0 };
+	size_t producerCachedHead = 0;
+
+	// Consumer only batch buffers, reused between drains.
+	alignas(cacheLineSize) std::vector<Timestamp> batchTimes;
+	std::vector<double> batchPrices;
+
+public:
+	// capacity is rounded up to a power of two, throws std::invalid_argument if it is 0.
+	explicit TickQueue(size_t capacity);
+	TickQueue(const TickQueue&) = delete;
+	TickQueue& operator=(const TickQueue&) = delete;
+
+	// Producer thread only. Returns false, dropping nothing, if the queue is full.
+	bool tryPush(Timestamp time, double price) noexcept;
+
+	// Consumer thread only. Appends up to maxTicks queued ticks to series in one batch and returns
+	// how many were drained.
+	size_t drainInto(TimeSeriesTransformations& series, size_t maxTicks = std::numeric_limits<size_t>::max());
+
+	size_t capacity() const noexcept;
+	// Exact from either thread when the other is idle, otherwise a snapshot.
+	size_t size() const noexcept;
+};
@@ -0,0 +1,394 @@
+// TimeSeriesKernels.cpp : Numeric kernels shared by the time series types.
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include "TimeSeriesKernels.h"
+
+#if !defined(TSS_SCALAR_KERNELS) && defined(__AVX2__)
+#define TSS_AVX2_KERNELS
+#include <immintrin.h>
+#elif !defined(TSS_SCALAR_KERNELS) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define TSS_SSE2_KERNELS
+#include <emmintrin.h>
+#endif
+
+// Values are summarised in blocks, each shifted by its first value so the sums of squares stay
+// small, and the blocks are then merged pairwise-style with Chan's update for numerical stability.
+const size_t summaryBlockSize = 4096;
+
+// Element i of a block: the value itself, or for increments the difference to the next value.
+template <bool Increments>
+double blockElement(const double* values, size_t i) {
+	if constexpr (Increments) {
+		return values[i + 1] - values[i];
+	}
+	else {
+		return values[i];
+	}
+}
+
+// Min and max that return NaN if either argument is NaN, std::min and std::max keep or drop a NaN
+// depending on which side it is on.
+double propagatingMin(double a, double b) {
+	return std::isnan(b) ? b : std::min(a, b);
+}
+
+double propagatingMax(double a, double b) {
+	return std::isnan(b) ? b : std::max(a, b);
+}
+
+// Sum of (x - shift), sum of (x - shift)^2, min and max of one block of count elements.
+// For increments the block reads count + 1 values and never materialises the differences.
+// The SIMD min and max instructions drop NaN lanes, so NaNs are tracked separately and any NaN
+// makes the block min and max NaN, the same as on the scalar path.
+template <bool Increments>
+void summarizeBlock(const double* values, size_t count, double shift, double* shiftedSum, double* shiftedSquares, double* minimum, double* maximum) {
+	size_t i = 0;
+	double sum = 0.0;
+	double squares = 0.0;
+	double low = blockElement<Increments>(values, 0);
+	double high = low;
+	bool seenNaN = false;
+
+#if defined(TSS_AVX2_KERNELS)
+	if (count >= 4) {
+		__m256d shiftLanes = _mm256_set1_pd(shift);
+		__m256d sumLanes = _mm256_setzero_pd();
+		__m256d squareLanes = _mm256_setzero_pd();
+		__m256d lowLanes = _mm256_set1_pd(low);
+		__m256d highLanes = lowLanes;
+		__m256d nanLanes = _mm256_setzero_pd();
+
+		for (; i + 4 <= count; i += 4) {
+			__m256d x = _mm256_loadu_pd(values + i);
+			if constexpr (Increments) {
+				x = _mm256_sub_pd(_mm256_loadu_pd(values + i + 1), x);
+			}
+			__m256d d = _mm256_sub_pd(x, shiftLanes);
+			sumLanes = _mm256_add_pd(sumLanes, d);
+			squareLanes = _mm256_add_pd(squareLanes, _mm256_mul_pd(d, d));
+			lowLanes = _mm256_min_pd(lowLanes, x);
+			highLanes = _mm256_max_pd(highLanes, x);
+			nanLanes = _mm256_or_pd(nanLanes, _mm256_cmp_pd(x, x, _CMP_UNORD_Q));
+		}
+
+		alignas(32) double lanes[4];
+		_mm256_store_pd(lanes, sumLanes);
+		sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+		_mm256_store_pd(lanes, squareLanes);
+		squares = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+		_mm256_store_pd(lanes, lowLanes);
+		low = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+		_mm256_store_pd(lanes, highLanes);
+		high = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+		seenNaN = _mm256_movemask_pd(nanLanes) != 0;
+	}
+#elif defined(TSS_SSE2_KERNELS)
+	if (count >= 2) {
+		__m128d shiftLanes = _mm_set1_pd(shift);
+		__m128d sumLanes = _mm_setzero_pd();
+		__m128d squareLanes = _mm_setzero_pd();
+		__m128d lowLanes = _mm_set1_pd(low);
+		__m128d highLanes = lowLanes;
+		__m128d nanLanes = _mm_setzero_pd();
+
+		for (; i + 2 <= count; i += 2) {
+			__m128d x = _mm_loadu_pd(values + i);
+			if constexpr (Increments) {
+				x = _mm_sub_pd(_mm_loadu_pd(values + i + 1), x);
+			}
+			__m128d d = _mm_sub_pd(x, shiftLanes);
+			sumLanes = _mm_add_pd(sumLanes, d);
+			squareLanes = _mm_add_pd(squareLanes, _mm_mul_pd(d, d));
+			lowLanes = _mm_min_pd(lowLanes, x);
+			highLanes = _mm_max_pd(highLanes, x);
+			nanLanes = _mm_or_pd(nanLanes, _mm_cmpunord_pd(x, x));
+		}
+
+		alignas(16) double lanes[2];
+		_mm_store_pd(lanes, sumLanes);
+		sum = lanes[0] + lanes[1];
+		_mm_store_pd(lanes, squareLanes);
+		squares = lanes[0] + lanes[1];
+		_mm_store_pd(lanes, lowLanes);
+		low = std::min(lanes[0], lanes[1]);
+		_mm_store_pd(lanes, highLanes);
+		high = std::max(lanes[0], lanes[1]);
+		seenNaN = _mm_movemask_pd(nanLanes) != 0;
+	}
+#endif
+
+	// Scalar tail, or the whole block without SIMD.
+	for (; i < count; i++) {
+		double x = blockElement<Increments>(values, i);
+		double d = x - shift;
+		sum += d;
+		squares += d * d;
+		low = propagatingMin(low, x);
+		high = propagatingMax(high, x);
+	}
+
+	if (seenNaN) {
+		low = std::numeric_limits<double>::quiet_NaN();
+		high = low;
+	}
+
+	*shiftedSum = sum;
+	*shiftedSquares = squares;
+	*minimum = low;
+	*maximum = high;
+}
+
+void accumulate(SummaryStatistics* stats, double value) noexcept {
+	if (stats->count == 0) {
+		*stats = SummaryStatistics();
+		stats->count = 1;
+		stats->sum = value;
+		stats->mean = value;
+		stats->min = value;
+		stats->max = value;
+		return;
+	}
+
+	stats->count++;
+	stats->sum += value;
+
+	double delta = value - stats->mean;
+	stats->mean += delta / stats->count;
+	stats->sumOfSquaredDeviations += delta * (value - stats->mean);
+	stats->variance = stats->sumOfSquaredDeviations / double(stats->count - 1);
+	stats->min = propagatingMin(stats->min, value);
+	stats->max = propagatingMax(stats->max, value);
+}
+
+SummaryStatistics mergeSummaries(const SummaryStatistics& left, const SummaryStatistics& right) noexcept {
+	if (left.count == 0) { return right; }
+	if (right.count == 0) { return left; }
+
+	SummaryStatistics merged;
+	merged.count = left.count + right.count;
+	merged.sum = left.sum + right.sum;
+
+	double leftCount = static_cast<double>(left.count);
+	double rightCount = static_cast<double>(right.count);
+	double delta = right.mean - left.mean;
+
+	merged.mean = left.mean + delta * rightCount / merged.count;
+	merged.sumOfSquaredDeviations = left.sumOfSquaredDeviations + right.sumOfSquaredDeviations + delta * delta * leftCount * rightCount / merged.count;
+	merged.variance = merged.sumOfSquaredDeviations / double(merged.count - 1);
+	merged.min = propagatingMin(left.min, right.min);
+	merged.max = propagatingMax(left.max, right.max);
+
+	return merged;
+}
+
+// Summarise count elements of values (or of their increments) block by block.
+template <bool Increments>
+SummaryStatistics summarizeBlocks(const double* values, size_t count) {
+	SummaryStatistics total;
+
+	for (size_t start = 0; start < count; start += summaryBlockSize) {
+		size_t blockCount = std::min(summaryBlockSize, count - start);
+		double shift = blockElement<Increments>(values, start);
+
+		double shiftedSum, shiftedSquares;
+		SummaryStatistics block;
+		summarizeBlock<Increments>(values + start, blockCount, shift, &shiftedSum, &shiftedSquares, &block.min, &block.max);
+
+		block.count = blockCount;
+		block.sum = blockCount * shift + shiftedSum;
+		block.mean = shift + shiftedSum / blockCount;
+		// Clamped to zero against rounding, with the difference first so a NaN is kept.
+		block.sumOfSquaredDeviations = std::max(shiftedSquares - shiftedSum * shiftedSum / blockCount, 0.0);
+		block.variance = block.sumOfSquaredDeviations / double(blockCount - 1);
+
+		total = mergeSummaries(total, block);
+	}
+
+	return total;
+}
+
+SummaryStatistics summarize(std::span<const double> values) noexcept {
+	return summarizeBlocks<false>(values.data(), values.size());
+}
+
+SummaryStatistics summarizeIncrements(std::span<const double> values) noexcept {
+	if (values.size() < 2) {
+		return SummaryStatistics();
+	}
+
+	SummaryStatistics stats = summarizeBlocks<true>(values.data(), values.size() - 1);
+
+	// The increments telescope, so their sum is exact without any accumulation error.
+	stats.sum = values.back() - values.front();
+	return stats;
+}
+
+// Neumaier's compensated sum, the running window sums add and remove every value once.
+struct CompensatedSum {
+	double sum = 0.0;
+	double compensation = 0.0;
+
+	void add(double value) {
+		double total = sum + value;
+		if (std::abs(sum) >= std::abs(value)) {
+			compensation += (sum - total) + value;
+		}
+		else {
+			compensation += (value - total) + sum;
+		}
+		sum = total;
+	}
+
+	double value() const { return sum + compensation; }
+};
+
+// Drop indices from the back of a monotonic deque that the new value dominates, then add it.
+// With Dominates = std::less_equal the front is always the window maximum, std::greater_equal the minimum.
+template <typename Dominates>
+void pushMonotonic(std::deque<size_t>& window, const double* values, size_t index, Dominates dominates) {
+	while (!window.empty() && dominates(values[window.back()], values[index])) {
+		window.pop_back();
+	}
+	window.push_back(index);
+}
+
+// Shared rolling engine. windowStart(i, first) returns the first row of the window ending at row i,
+// given the first row of the previous window, so it only ever moves forwards.
+template <typename WindowStart>
+RollingStatistics rollingWindows(std::span<const double> values, WindowStart windowStart) {
+	const size_t count = values.size();
+	RollingStatistics rolling;
+	rolling.count.resize(count);
+	rolling.mean.resize(count);
+	rolling.standardDeviation.resize(count);
+	rolling.min.resize(count);
+	rolling.max.resize(count);
+
+	std::deque<size_t> minimums, maximums;
+	CompensatedSum sum, squares;
+	double shift = 0.0;
+	size_t first = 0;
+	size_t rebaseRow = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		size_t windowFirst = windowStart(i, first);
+
+		for (; first < windowFirst; first++) {
+			double shifted = values[first] - shift;
+			sum.add(-shifted);
+			squares.add(-shifted * shifted);
+		}
+
+		// Once every row present at the last rebase has left the window, the sums are rebuilt around
+		// the newest value. Drifting prices then never leave a large shift behind, and the rebuilds
+		// cost O(n) in total because each one only reads rows added since the previous rebuild.
+		if (first >= rebaseRow) {
+			shift = values[i];
+			sum = CompensatedSum();
+			squares = CompensatedSum();
+			for (size_t row = first; row < i; row++) {
+				double shifted = values[row] - shift;
+				sum.add(shifted);
+				squares.add(shifted * shifted);
+			}
+			rebaseRow = i + 1;
+		}
+
+		double shifted = values[i] - shift;
+		sum.add(shifted);
+		squares.add(shifted * shifted);
+
+		pushMonotonic(minimums, values.data(), i, std::greater_equal<double>());
+		pushMonotonic(maximums, values.data(), i, std::less_equal<double>());
+		while (minimums.front() < first) { minimums.pop_front(); }
+		while (maximums.front() < first) { maximums.pop_front(); }
+
+		size_t windowCount = i - first + 1;
+		double windowSum = sum.value();
+		double sumOfSquaredDeviations = std::max(0.0, squares.value() - windowSum * windowSum / windowCount);
+
+		rolling.count[i] = windowCount;
+		rolling.mean[i] = shift + windowSum / windowCount;
+		rolling.standardDeviation[i] = std::sqrt(sumOfSquaredDeviations / double(windowCount - 1));
+		rolling.min[i] = values[minimums.front()];
+		rolling.max[i] = values[maximums.front()];
+	}
+
+	return rolling;
+}
+
+RollingStatistics rollingStatistics(std::span<const double> values, size_t windowSize) {
+	windowSize = std::max<size_t>(windowSize, 1);
+	return rollingWindows(values, [windowSize](size_t i, size_t) { return (i + 1 > windowSize) ? i + 1 - windowSize : 0; });
+}
+
+RollingStatistics rollingStatistics(std::span<const std::int64_t> times, std::span<const double> values, std::int64_t windowLength) {
+	return rollingWindows(values, [times, windowLength](size_t i, size_t first) {
+		while (first < i && times[first] <= times[i] - windowLength) { first++; }
+		return first;
+		});
+}
+
+// Start of the bucket holding time, rounding towards negative infinity for negative times.
+std::int64_t bucketStart(std::int64_t time, std::int64_t bucketLength) {
+	std::int64_t remainder = time % bucketLength;
+	return (remainder < 0) ? time - remainder - bucketLength : time - remainder;
+}
+
+OhlcBars resampleOhlc(std::span<const std::int64_t> times, std::span<const double> values, std::int64_t bucketLength) {
+	OhlcBars bars;
+	if (times.empty()) { return bars; }
+
+	// Sorted input means the bar count is at most the time span in buckets, and never more than the rows.
+	std::int64_t spannedBuckets = (bucketStart(times.back(), bucketLength) - bucketStart(times.front(), bucketLength)) / bucketLength + 1;
+	size_t expectedBars = static_cast<size_t>(std::min<std::int64_t>(spannedBuckets, static_cast<std::int64_t>(times.size())));
+	bars.start.resize(expectedBars);
+	bars.open.resize(expectedBars);
+	bars.high.resize(expectedBars);
+	bars.low.resize(expectedBars);
+	bars.close.resize(expectedBars);
+	bars.count.resize(expectedBars);
+	bars.mean.resize(expectedBars);
+
+	size_t bar = 0;
+	size_t i = 0;
+	while (i < times.size()) {
+		std::int64_t start = bucketStart(times[i], bucketLength);
+		std::int64_t end = start + bucketLength;
+		double open = values[i];
+		double high = open;
+		double low = open;
+		// Summed relative to the open so a bucket of large, close prices keeps its precision.
+		double shiftedSum = 0.0;
+		size_t first = i;
+
+		for (; i < times.size() && times[i] < end; i++) {
+			high = std::max(high, values[i]);
+			low = std::min(low, values[i]);
+			shiftedSum += values[i] - open;
+		}
+
+		size_t count = i - first;
+		bars.start[bar] = start;
+		bars.open[bar] = open;
+		bars.high[bar] = high;
+		bars.low[bar] = low;
+		bars.close[bar] = values[i - 1];
+		bars.count[bar] = count;
+		bars.mean[bar] = open + shiftedSum / count;
+		bar++;
+	}
+
+	// Gaps leave fewer bars than buckets spanned.
+	bars.start.resize(bar);
+	bars.open.resize(bar);
+	bars.high.resize(bar);
+	bars.low.resize(bar);
+	bars.close.resize(bar);
+	bars.count.resize(bar);
+	bars.mean.resize(bar);
+
+	return bars;
+}
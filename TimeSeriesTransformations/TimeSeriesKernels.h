@@ -0,0 +1,65 @@
+#pragma once
+#include <span>
+#include <limits>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Summary of a sequence of values. variance is the sample variance (divided by count - 1) and
+// sumOfSquaredDeviations is the running state needed to merge or extend a summary.
+struct SummaryStatistics {
+	size_t count = 0;
+	double sum = 0.0;
+	double mean = std::numeric_limits<double>::quiet_NaN();
+	double variance = std::numeric_limits<double>::quiet_NaN();
+	double sumOfSquaredDeviations = 0.0;
+	double min = std::numeric_limits<double>::quiet_NaN();
+	double max = std::numeric_limits<double>::quiet_NaN();
+};
+
+// Count, sum, mean, variance, min and max in a single pass. Uses AVX2 or SSE2 when the compiler
+// targets them (define TSS_SCALAR_KERNELS to force the scalar path). A NaN value makes every field
+// but count NaN, wherever it sits and on every path, as do accumulate and mergeSummaries.
+SummaryStatistics summarize(std::span<const double> values) noexcept;
+
+// Summary of the increments values[i + 1] - values[i], computed in one pass without a diff vector.
+SummaryStatistics summarizeIncrements(std::span<const double> values) noexcept;
+
+// Add one value to a summary in O(1) (Welford's update).
+void accumulate(SummaryStatistics* stats, double value) noexcept;
+
+// Combine the summaries of two disjoint sequences.
+SummaryStatistics mergeSummaries(const SummaryStatistics& left, const SummaryStatistics& right) noexcept;
+
+// Statistics of the window ending at every row, one column entry per input row. Windows at the
+// start of the series hold fewer rows, count records how many.
+struct RollingStatistics {
+	std::vector<size_t> count;
+	std::vector<double> mean;
+	std::vector<double> standardDeviation;
+	std::vector<double> min;
+	std::vector<double> max;
+};
+
+// Rolling statistics over the last windowSize values (at least 1) in O(n): compensated running sums
+// for the mean and deviation and monotonic deques for the min and max.
+RollingStatistics rollingStatistics(std::span<const double> values, size_t windowSize);
+
+// Rolling statistics over the values whose times lie in (times[i] - windowLength, times[i]].
+// times must be sorted and windowLength positive.
+RollingStatistics rollingStatistics(std::span<const std::int64_t> times, std::span<const double> values, std::int64_t windowLength);
+
+// Open, high, low, close, tick count and mean price of every non-empty time bucket, one entry per bar.
+// start is the first time of the bucket, buckets are aligned to multiples of the bucket length.
+struct OhlcBars {
+	std::vector<std::int64_t> start;
+	std::vector<double> open;
+	std::vector<double> high;
+	std::vector<double> low;
+	std::vector<double> close;
+	std::vector<size_t> count;
+	std::vector<double> mean;
+};
+
+// Resample sorted (time, value) rows into bars of bucketLength (positive) in a single pass.
+OhlcBars resampleOhlc(std::span<const std::int64_t> times, std::span<const double> values, std::int64_t bucketLength);
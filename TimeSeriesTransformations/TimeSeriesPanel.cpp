@@ -0,0 +1,206 @@
+// TimeSeriesPanel.cpp : Many time series stored in one columnar arena.
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include "TimeSeriesPanel.h"
+
+// Split the series into at most threadCount ranges of roughly equal row counts and run
+// work(firstSeries, lastSeries) on each. A threadCount of 0 only goes parallel for large panels.
+template <typename Work>
+void forSeriesRanges(const std::vector<size_t>& offsets, unsigned int threadCount, Work work) {
+	const size_t minimumAutomaticRowsPerThread = 1 << 18;
+	size_t seriesCount = offsets.size() - 1;
+	size_t rowCount = offsets.back();
+
+	size_t chunkCount = threadCount;
+	if (chunkCount == 0) {
+		chunkCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), rowCount / minimumAutomaticRowsPerThread);
+	}
+	chunkCount = std::max<size_t>(1, std::min(chunkCount, seriesCount));
+
+	if (chunkCount == 1) {
+		work(size_t(0), seriesCount);
+		return;
+	}
+
+	// Chunk boundaries are the series holding every chunkCount'th share of the rows.
+	std::vector<size_t> boundaries{ 0 };
+	for (size_t i = 1; i < chunkCount; i++) {
+		size_t series = std::upper_bound(offsets.begin(), offsets.end(), rowCount * i / chunkCount) - offsets.begin() - 1;
+		boundaries.push_back(std::clamp(series, boundaries.back(), seriesCount));
+	}
+	boundaries.push_back(seriesCount);
+
+	std::vector<std::future<void>> chunks;
+	for (size_t i = 0; i < chunkCount; i++) {
+		if (boundaries[i] < boundaries[i + 1]) {
+			chunks.push_back(std::async(std::launch::async, work, boundaries[i], boundaries[i + 1]));
+		}
+	}
+
+	// get() rethrows any error from the workers.
+	for (auto& chunk : chunks) {
+		chunk.get();
+	}
+}
+
+TimeSeriesPanel::TimeSeriesPanel(TimeResolution resolution) : resolution(resolution) { }
+
+void TimeSeriesPanel::addSeries(const TimeSeriesTransformations& series) {
+	if (series.getResolution() != resolution) {
+		throw std::invalid_argument("Series " + series.getName() + " does not match the panel time resolution.");
+	}
+
+	std::span<const Timestamp> seriesTimes = series.getTimeView();
+	std::span<const double> seriesPrices = series.getPriceView();
+
+	times.insert(times.end(), seriesTimes.begin(), seriesTimes.end());
+	prices.insert(prices.end(), seriesPrices.begin(), seriesPrices.end());
+	offsets.push_back(times.size());
+
+	names += series.getName();
+	nameOffsets.push_back(names.size());
+}
+
+// Unsorted input goes through the series constructor, which orders it by time.
+void TimeSeriesPanel::addSeries(const std::string& name, const std::vector<Timestamp>& timeVec, const std::vector<double>& priceVec) {
+	addSeries(TimeSeriesTransformations(resolution, timeVec, priceVec, name));
+}
+
+size_t TimeSeriesPanel::seriesCount() const noexcept {
+	return offsets.size() - 1;
+}
+
+size_t TimeSeriesPanel::count() const noexcept {
+	return times.size();
+}
+
+TimeResolution TimeSeriesPanel::getResolution() const noexcept {
+	return resolution;
+}
+
+void TimeSeriesPanel::checkSeries(size_t series) const {
+	if (series >= seriesCount()) {
+		throw std::out_of_range("Series " + std::to_string(series) + " is not in the panel.");
+	}
+}
+
+std::string_view TimeSeriesPanel::getName(size_t series) const {
+	checkSeries(series);
+	return std::string_view(names).substr(nameOffsets[series], nameOffsets[series + 1] - nameOffsets[series]);
+}
+
+bool TimeSeriesPanel::findSeries(std::string_view name, size_t* series) const noexcept {
+	for (size_t i = 0; i < seriesCount(); i++) {
+		if (std::string_view(names).substr(nameOffsets[i], nameOffsets[i + 1] - nameOffsets[i]) == name) {
+			*series = i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+TimePriceView TimeSeriesPanel::getView(size_t series) const {
+	checkSeries(series);
+	return TimePriceView(times, prices).subview(offsets[series], offsets[series + 1] - offsets[series]);
+}
+
+TimeSeriesTransformations TimeSeriesPanel::getSeries(size_t series) const {
+	TimePriceView view = getView(series);
+	std::span<const Timestamp> seriesTimes = view.getTimeView();
+	std::span<const double> seriesPrices = view.getPriceView();
+
+	return TimeSeriesTransformations(resolution, std::vector<Timestamp>(seriesTimes.begin(), seriesTimes.end()),
+		std::vector<double>(seriesPrices.begin(), seriesPrices.end()), std::string(getName(series)));
+}
+
+std::vector<SummaryStatistics> TimeSeriesPanel::summaries(unsigned int threadCount) const {
+	std::vector<SummaryStatistics> results(seriesCount());
+
+	forSeriesRanges(offsets, threadCount, [&](size_t first, size_t last) {
+		for (size_t i = first; i < last; i++) {
+			results[i] = summarize(std::span<const double>(prices).subspan(offsets[i], offsets[i + 1] - offsets[i]));
+		}
+		});
+
+	return results;
+}
+
+std::vector<SummaryStatistics> TimeSeriesPanel::incrementSummaries(unsigned int threadCount) const {
+	std::vector<SummaryStatistics> results(seriesCount());
+
+	forSeriesRanges(offsets, threadCount, [&](size_t first, size_t last) {
+		for (size_t i = first; i < last; i++) {
+			results[i] = summarizeIncrements(std::span<const double>(prices).subspan(offsets[i], offsets[i + 1] - offsets[i]));
+		}
+		});
+
+	return results;
+}
+
+bool TimeSeriesPanel::crossSection(Timestamp unixEpochTime, SummaryStatistics* stats) const {
+	Timestamp lastTick = (unixEpochTime + 1) * ticksPerSecond(resolution) - 1;
+	std::vector<double> lastPrices;
+	lastPrices.reserve(seriesCount());
+
+	for (size_t i = 0; i < seriesCount(); i++) {
+		auto seriesBegin = times.begin() + offsets[i];
+		auto after = std::upper_bound(seriesBegin, times.begin() + offsets[i + 1], lastTick);
+		if (after != seriesBegin) {
+			lastPrices.push_back(prices[after - times.begin() - 1]);
+		}
+	}
+
+	*stats = summarize(lastPrices);
+	return !lastPrices.empty();
+}
+
+// Drop every row where removeRow(time, price) holds, sliding the kept rows down and rewriting the
+// offsets as each series is passed. Returns whether anything was removed.
+template <typename RemoveRow>
+bool TimeSeriesPanel::compact(RemoveRow removeRow) {
+	size_t kept = 0;
+	size_t seriesStart = 0;
+
+	for (size_t series = 0; series < seriesCount(); series++) {
+		size_t seriesEnd = offsets[series + 1];
+
+		for (size_t i = seriesStart; i < seriesEnd; i++) {
+			if (!removeRow(times[i], prices[i])) {
+				times[kept] = times[i];
+				prices[kept] = prices[i];
+				kept++;
+			}
+		}
+
+		seriesStart = seriesEnd;
+		offsets[series + 1] = kept;
+	}
+
+	bool removed = kept != times.size();
+	times.resize(kept);
+	prices.resize(kept);
+
+	return removed;
+}
+
+bool TimeSeriesPanel::removePricesGreaterThan(double priceCondition) {
+	return compact([priceCondition](Timestamp, double price) { return price > priceCondition; });
+}
+
+bool TimeSeriesPanel::removePricesLowerThan(double priceCondition) {
+	return compact([priceCondition](Timestamp, double price) { return price < priceCondition; });
+}
+
+bool TimeSeriesPanel::removePricesBefore(Timestamp unixEpochTime) {
+	Timestamp firstKept = unixEpochTime * ticksPerSecond(resolution);
+	return compact([firstKept](Timestamp time, double) { return time < firstKept; });
+}
+
+// Every tick within the second unixEpochTime is kept.
+bool TimeSeriesPanel::removePricesAfter(Timestamp unixEpochTime) {
+	Timestamp firstRemoved = (unixEpochTime + 1) * ticksPerSecond(resolution);
+	return compact([firstRemoved](Timestamp time, double) { return time >= firstRemoved; });
+}
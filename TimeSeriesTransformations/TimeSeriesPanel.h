@@ -0,0 +1,56 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include "TimeSeriesTransformations.h"
+
+// Many series held in one columnar arena. The rows of series i are [offsets[i], offsets[i + 1]) of the
+// shared time and price columns, and every name lives in one string, so a panel of thousands of tickers
+// costs a handful of allocations rather than several per ticker. Each series is kept sorted by time.
+class TimeSeriesPanel {
+	std::vector<Timestamp> times;
+	std::vector<double> prices;
+	std::vector<size_t> offsets{ 0 };
+
+	std::string names;
+	std::vector<size_t> nameOffsets{ 0 };
+
+	TimeResolution resolution = TimeResolution::Seconds;
+
+	void checkSeries(size_t series) const;
+	template <typename RemoveRow>
+	bool compact(RemoveRow removeRow);
+
+public:
+	explicit TimeSeriesPanel(TimeResolution resolution = TimeResolution::Seconds);
+
+	// Append a series to the arena. Series must share the panel resolution.
+	void addSeries(const TimeSeriesTransformations& series);
+	void addSeries(const std::string& name, const std::vector<Timestamp>& timeVec, const std::vector<double>& priceVec);
+
+	size_t seriesCount() const noexcept;
+	// Total rows across every series.
+	size_t count() const noexcept;
+	TimeResolution getResolution() const noexcept;
+
+	std::string_view getName(size_t series) const;
+	bool findSeries(std::string_view name, size_t* series) const noexcept;
+	// View of one series, valid until the panel is next modified.
+	TimePriceView getView(size_t series) const;
+	TimeSeriesTransformations getSeries(size_t series) const;
+
+	// Per series statistics, computed on threadCount threads (0 picks from the panel size and core count).
+	std::vector<SummaryStatistics> summaries(unsigned int threadCount = 0) const;
+	std::vector<SummaryStatistics> incrementSummaries(unsigned int threadCount = 0) const;
+
+	// Cross sectional summary of the last price at or before unix second unixEpochTime (any tick within
+	// that second counts) in every series that has one, like removePricesAfter below.
+	bool crossSection(Timestamp unixEpochTime, SummaryStatistics* stats) const;
+
+	// Filters applied to every series in a single compaction pass over the arena.
+	bool removePricesGreaterThan(double price);
+	bool removePricesLowerThan(double price);
+	bool removePricesBefore(Timestamp unixEpochTime);
+	bool removePricesAfter(Timestamp unixEpochTime);
+};
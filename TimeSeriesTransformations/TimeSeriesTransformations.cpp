@@ -1,129 +1,356 @@
 // TimeSeriesTransformations.cpp : Defines the functions for the static library.
 #define _CRT_SECURE_NO_WARNINGS
 #include <stdlib.h>
-#include <time.h>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <string>
 #include <numeric>
-#include <ctime>
-#include <iomanip>
 #include <stdexcept>
 #include <algorithm>
 #include <limits>
 #include <memory>
+#include <cmath>
+#include <cstring>
+#include <charconv>
+#include <future>
+#include <thread>
+#include <cstdint>
+#include <utility>
 #include "TimeSeriesTransformations.h"
+#include "MappedFile.h"
+#include "DateTime.h"
 
 
 // Helper functions.
-std::vector<double> vectorDiff(const std::vector<double>& v) {
 
-	if (v.size() < 2) {
-		throw std::invalid_argument("Vector provided to vectorDiff must be at least two elements.");
-	}
-
-	std::vector<double> diff;
-	std::adjacent_difference(v.begin(), v.end(), std::back_inserter(diff));
-	diff.erase(diff.begin());
+// UTC day containing a time measured in units of 1 / unitsPerDay of a day, rounding towards negative
+// infinity for times before 1970.
+std::int64_t dayOfTime(std::int64_t time, std::int64_t unitsPerDay) {
+	std::int64_t day = time / unitsPerDay;
+	return (time % unitsPerDay < 0) ? day - 1 : day;
+}
 
-	return diff;
+// Narrow a tick to the int the legacy accessors return.
+int checkedInt(Timestamp time) {
+	if (time < std::numeric_limits<int>::min() || time > std::numeric_limits<int>::max()) {
+		throw std::overflow_error("Time " + std::to_string(time) + " does not fit in an int.");
+	}
+	return static_cast<int>(time);
 }
 
-// Convert human readable date to unix epoch timestamp.
-bool stringDateToUnix(const std::string& date, int* unix_epoch) {
-	std::tm t{};
-	std::istringstream string_stream(date);
+// One value per line in the fixed six decimal format of std::to_string, written into a single reserved
+// buffer rather than concatenating temporaries. valueAt(i) supplies the value of row i in [first, last).
+template <typename ValueAt>
+std::string formatValueLines(size_t first, size_t last, ValueAt valueAt) {
+	std::string lines;
+	lines.reserve((last - first) * 16);
+
+	// Large enough for any double in fixed notation.
+	char buffer[512];
 
-	if (date.size() == 10) {
-		string_stream >> std::get_time(&t, "%Y-%m-%d");
+	for (size_t i = first; i < last; i++) {
+		char* end = std::to_chars(buffer, buffer + sizeof(buffer), valueAt(i), std::chars_format::fixed, 6).ptr;
+		lines.append(buffer, end);
+		lines.push_back('\n');
 	}
-	else {
-		string_stream >> std::get_time(&t, "%Y-%m-%d %H:%M:%S");
+
+	return lines;
+}
+
+// Remove every row matching predicate(time, price) in a single compaction pass. The columns are only
+// detached from any sharing copies once a row is known to match. Returns whether anything was removed.
+template <typename Predicate>
+bool TimeSeriesTransformations::eraseRowsWhere(Predicate predicate) {
+	size_t firstRemoved = 0;
+	while (firstRemoved < columns->times.size() && !predicate(columns->times[firstRemoved], columns->prices[firstRemoved])) {
+		firstRemoved++;
 	}
 
-	// Check if the date has been parsed correctly.
-	if (string_stream.fail()) {
+	if (firstRemoved == columns->times.size()) {
 		return false;
 	}
 
-	*unix_epoch = mktime(&t);
+	Columns& owned = writableColumns();
+	std::vector<Timestamp>& times = owned.times;
+	std::vector<double>& prices = owned.prices;
+	size_t kept = firstRemoved;
+
+	for (size_t i = firstRemoved + 1; i < times.size(); i++) {
+		if (!predicate(times[i], prices[i])) {
+			times[kept] = times[i];
+			prices[kept] = prices[i];
+			kept++;
+		}
+	}
+
+	times.resize(kept);
+	prices.resize(kept);
+	invalidateCaches();
 
 	return true;
 }
 
-// Convert unix epoch timestamp to a readable date format.
-std::string unixEpochToString(const int input_time) {
-	struct tm* timeinfo;
-	time_t epochTime = input_time;
-	timeinfo = gmtime(&epochTime);
+// Stable sort of the rows [start, end) of both columns by time, skipped when already in order.
+void sortRowsByTime(std::vector<Timestamp>& times, std::vector<double>& prices, size_t start, size_t end) {
+	if (std::is_sorted(times.begin() + start, times.begin() + end)) {
+		return;
+	}
+
+	// Sort a permutation by time, then gather both columns through it.
+	std::vector<size_t> order(end - start);
+	std::iota(order.begin(), order.end(), start);
+	std::stable_sort(order.begin(), order.end(), [&times](size_t left, size_t right) { return times[left] < times[right]; });
 
-	std::stringstream s;
-	s << std::put_time(timeinfo, "%Y-%m-%d %H:%M:%S");
-	return s.str();
+	std::vector<Timestamp> sortedTimes(order.size());
+	std::vector<double> sortedPrices(order.size());
+	for (size_t i = 0; i < order.size(); i++) {
+		sortedTimes[i] = times[order[i]];
+		sortedPrices[i] = prices[order[i]];
+	}
+
+	std::copy(sortedTimes.begin(), sortedTimes.end(), times.begin() + start);
+	std::copy(sortedPrices.begin(), sortedPrices.end(), prices.begin() + start);
 }
 
-// Check if a date is valid.
-bool isDateValid(const std::string& date) {
-	int unixEpochTimestamp;
-	stringDateToUnix(date, &unixEpochTimestamp);
+// Empty constructor.
+TimeSeriesTransformations::TimeSeriesTransformations() { }
 
-	std::string comparisonDate = unixEpochToString(unixEpochTimestamp);
+// Read an entire file into memory with a single allocation.
+std::string readWholeFile(std::ifstream& file) {
+	std::string buffer;
 
-	if (comparisonDate == date) {
-		return true;
+	file.seekg(0, std::ios::end);
+	std::streamoff size = file.tellg();
+	file.seekg(0, std::ios::beg);
+
+	if (size > 0) {
+		buffer.resize(static_cast<size_t>(size));
+		file.read(buffer.data(), size);
+		buffer.resize(static_cast<size_t>(file.gcount()));
 	}
 	else {
-		if (std::string(comparisonDate.begin() + 11, comparisonDate.end()) == "00:00:00") {
-			return (std::string(comparisonDate.begin(), comparisonDate.end() - 9) == date);
-		}
-		return false;
+		// Size unknown (e.g. a pipe), fall back to reading until end of stream.
+		file.clear();
+		buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
 	}
+
+	return buffer;
 }
 
-// Empty constructor.
-TimeSeriesTransformations::TimeSeriesTransformations() { }
+// Find the end of the line starting at first, or last if there is no newline.
+const char* findLineEnd(const char* first, const char* last) {
+	const void* newline = std::memchr(first, '\n', last - first);
+	return newline ? static_cast<const char*>(newline) : last;
+}
 
-// Constructor using the filepath.
-TimeSeriesTransformations::TimeSeriesTransformations(const std::string& filenameAndPath) {
-	std::string line;
-	std::ifstream csv(filenameAndPath);
+// Find the separator within a line, or last if it is not present.
+const char* findSeparator(const char* first, const char* last, char separator) {
+	const void* found = std::memchr(first, separator, last - first);
+	return found ? static_cast<const char*>(found) : last;
+}
 
-	if (!csv.is_open()) {
-		throw std::runtime_error("Unable to open file " + filenameAndPath);
+const char* skipSpaces(const char* first, const char* last) {
+	while (first != last && (*first == ' ' || *first == '\t')) {
+		first++;
+	}
+	return first;
+}
+
+// Estimate the number of rows from the average length of the first few lines.
+size_t estimateRowCount(const char* first, const char* last) {
+	const size_t sampleLines = 64;
+	const char* position = first;
+	size_t lines = 0;
+
+	while (position != last && lines < sampleLines) {
+		position = findLineEnd(position, last);
+		if (position != last) { position++; }
+		lines++;
 	}
 
-	std::string stringTime;
-	std::string stringPrice;
+	if (lines == 0 || position == first) { return 0; }
 
-	double powerOf10 = std::pow(10, decimalPlaces);
+	size_t averageLength = static_cast<size_t>(position - first) / lines;
+	// Slight overestimate so varying line lengths rarely trigger a reallocation.
+	return static_cast<size_t>(last - first) / averageLength + sampleLines;
+}
+
+// Parse the csv rows in [first, last) and append them to the columns, without any per line allocations.
+// Returns whether the rows were already in time order. bufferStart is only used for error messages.
+bool parseCsvRows(const char* bufferStart, const char* first, const char* last, char separator, double powerOf10, std::vector<Timestamp>* times, std::vector<double>* prices) {
+	bool sorted = true;
+	const char* position = first;
+
+	// Iterate down the buffer line by line until the end of the chunk.
+	while (position != last) {
+		const char* lineEnd = findLineEnd(position, last);
+		const char* rowEnd = (lineEnd != position && lineEnd[-1] == '\r') ? lineEnd - 1 : lineEnd;
+		const char* timeStart = skipSpaces(position, rowEnd);
+
+		if (timeStart != rowEnd) {
+			const char* timeEnd = findSeparator(timeStart, rowEnd, separator);
+			const char* priceStart = (timeEnd == rowEnd) ? rowEnd : skipSpaces(timeEnd + 1, rowEnd);
+			const char* priceEnd = findSeparator(priceStart, rowEnd, separator);
+
+			Timestamp time;
+			double price;
+			auto timeResult = std::from_chars(timeStart, timeEnd, time);
+			auto priceResult = std::from_chars(priceStart, priceEnd, price);
+
+			if (timeResult.ec != std::errc() || priceResult.ec != std::errc()) {
+				// Only count lines on the error path, chunks do not know their line offset.
+				size_t lineNumber = std::count(bufferStart, position, '\n') + 1;
+				throw std::invalid_argument("Unable to parse line " + std::to_string(lineNumber) + ".");
+			}
+
+			if (!times->empty() && time < times->back()) {
+				sorted = false;
+			}
+
+			times->push_back(time);
+			prices->push_back(std::round(price * powerOf10) / powerOf10);
+		}
+
+		position = (lineEnd == last) ? last : lineEnd + 1;
+	}
+
+	return sorted;
+}
+
+// Parse a csv held entirely in memory, splitting the rows into chunks parsed in parallel.
+// A threadCount of 0 picks one chunk per core, but only for buffers big enough to benefit.
+void TimeSeriesTransformations::loadCsvBuffer(const char* first, const char* last, unsigned int threadCount) {
+	Columns& owned = writableColumns();
+	std::vector<Timestamp>& times = owned.times;
+	std::vector<double>& prices = owned.prices;
+	const double powerOf10 = std::pow(10, decimalPlaces);
+	const size_t minimumChunkBytes = 1 << 20;
 
 	// Get data from file header.
-	std::getline(csv, line);
-	std::istringstream xyz{ line };
+	const char* lineEnd = findLineEnd(first, last);
+	const char* headerEnd = (lineEnd != first && lineEnd[-1] == '\r') ? lineEnd - 1 : lineEnd;
+
+	// Skip the time column header, the actual name of the share price column follows it.
+	const char* nameStart = findSeparator(first, headerEnd, separator);
+	if (nameStart != headerEnd) {
+		nameStart++;
+		name.assign(nameStart, findSeparator(nameStart, headerEnd, separator));
+	}
 
-	std::string colName;
+	const char* body = (lineEnd == last) ? last : lineEnd + 1;
+	size_t bodyBytes = last - body;
 
-	// Just somewhere to ditch the time column header.
-	std::getline(xyz, line, this->getSeparator());
-	// Actual name of the share price column.
-	std::getline(xyz, colName, this->getSeparator());
-	name = colName;
+	const size_t coreCount = std::max(1u, std::thread::hardware_concurrency());
+	size_t chunkCount = threadCount;
+	if (chunkCount == 0) {
+		chunkCount = std::min<size_t>(coreCount, bodyBytes / minimumChunkBytes);
+	}
+	chunkCount = std::max<size_t>(1, std::min(chunkCount, bodyBytes));
 
-	// Iterate down the file line by line until end of file.
-	while (std::getline(csv, line)) {
-		std::istringstream iss{ line };
+	if (chunkCount == 1) {
+		size_t estimatedRows = estimateRowCount(body, last);
+		times.reserve(estimatedRows);
+		prices.reserve(estimatedRows);
 
-		std::getline(iss, stringTime, this->getSeparator());
-		std::getline(iss, stringPrice, this->getSeparator());
+		if (!parseCsvRows(first, body, last, separator, powerOf10, &times, &prices)) {
+			sortInternals();
+		}
+		return;
+	}
 
-		int time = std::stoi(stringTime);
-		double price = std::round(std::stod(stringPrice) * powerOf10) / powerOf10;
+	// Split the body on newline boundaries so every chunk holds whole rows.
+	std::vector<const char*> boundaries{ body };
+	for (size_t i = 1; i < chunkCount; i++) {
+		const char* split = std::max(body + bodyBytes * i / chunkCount, boundaries.back());
+		split = findLineEnd(split, last);
+		boundaries.push_back((split == last) ? last : split + 1);
+	}
+	boundaries.push_back(last);
+
+	std::vector<std::vector<Timestamp>> chunkTimes(chunkCount);
+	std::vector<std::vector<double>> chunkPrices(chunkCount);
+
+	// An explicit threadCount still splits the body that many ways, but the chunks are parsed on no
+	// more threads than there are cores or minimum sized chunks, worker w taking every workerCount'th.
+	size_t workerCount = std::min({ chunkCount, coreCount, std::max<size_t>(1, bodyBytes / minimumChunkBytes) });
+	auto parseChunks = [&](size_t worker) {
+		bool sorted = true;
+		for (size_t i = worker; i < chunkCount; i += workerCount) {
+			size_t estimatedRows = estimateRowCount(boundaries[i], boundaries[i + 1]);
+			chunkTimes[i].reserve(estimatedRows);
+			chunkPrices[i].reserve(estimatedRows);
+			sorted = parseCsvRows(first, boundaries[i], boundaries[i + 1], separator, powerOf10, &chunkTimes[i], &chunkPrices[i]) && sorted;
+		}
+		return sorted;
+	};
 
-		timePricePairs.emplace_back(time, price);
+	std::vector<std::future<bool>> workerSorted;
+	for (size_t worker = 1; worker < workerCount; worker++) {
+		workerSorted.push_back(std::async(std::launch::async, parseChunks, worker));
 	}
 
-	sortInternals();
+	// The calling thread parses its share too, get() rethrows any parse error from the others.
+	bool allChunksSorted = parseChunks(0);
+	for (std::future<bool>& sorted : workerSorted) {
+		allChunksSorted = sorted.get() && allChunksSorted;
+	}
+
+	size_t totalRows = 0;
+	for (size_t i = 0; i < chunkCount; i++) {
+		totalRows += chunkTimes[i].size();
+	}
+
+	std::vector<size_t> runEnds;
+	times.reserve(totalRows);
+	prices.reserve(totalRows);
+	for (size_t i = 0; i < chunkCount; i++) {
+		times.insert(times.end(), chunkTimes[i].begin(), chunkTimes[i].end());
+		prices.insert(prices.end(), chunkPrices[i].begin(), chunkPrices[i].end());
+		runEnds.push_back(times.size());
+		std::vector<Timestamp>().swap(chunkTimes[i]);
+		std::vector<double>().swap(chunkPrices[i]);
+	}
+
+	if (allChunksSorted) {
+		mergeSortedRuns(runEnds);
+	}
+	else {
+		sortInternals();
+	}
+}
+
+// Open a csv, memory mapping it where possible, and parse it.
+void TimeSeriesTransformations::loadFile(const std::string& filenameAndPath, unsigned int threadCount) {
+	MappedFile mapped(filenameAndPath);
+
+	if (mapped.isMapped()) {
+		loadCsvBuffer(mapped.data(), mapped.data() + mapped.size(), threadCount);
+	}
+	else {
+		// Pipes and empty files cannot be mapped, read them through a stream instead.
+		std::ifstream csv(filenameAndPath, std::ios::binary);
+
+		if (!csv.is_open()) {
+			throw std::runtime_error("Unable to open file " + filenameAndPath);
+		}
+
+		std::string buffer = readWholeFile(csv);
+		loadCsvBuffer(buffer.data(), buffer.data() + buffer.size(), threadCount);
+	}
+}
+
+// Constructor using the filepath.
+TimeSeriesTransformations::TimeSeriesTransformations(const std::string& filenameAndPath, TimeResolution resolution) : resolution(resolution) {
+	loadFile(filenameAndPath, 0);
+}
+
+// Load a csv split into threadCount chunks (0 picks automatically), see loadCsvBuffer for the threads used.
+TimeSeriesTransformations TimeSeriesTransformations::load(const std::string& filenameAndPath, unsigned int threadCount, TimeResolution resolution) {
+	TimeSeriesTransformations series;
+	series.resolution = resolution;
+	series.loadFile(filenameAndPath, threadCount);
+	return series;
 }
 
 // Constructor from std::vector inputs directly.
@@ -132,25 +359,93 @@ TimeSeriesTransformations::TimeSeriesTransformations(const std::vector<int>& tim
 		throw std::runtime_error("Price and time vectors are not equally sized.");
 	}
 
-	for (int i = 0; i < price.size(); i++) {
-		timePricePairs.emplace_back(time[i], price[i]);
+	columns = std::make_shared<Columns>(Columns{ std::vector<Timestamp>(time.begin(), time.end()), price });
+
+	sortInternals();
+}
+
+// Constructor from ticks of the given resolution.
+TimeSeriesTransformations::TimeSeriesTransformations(TimeResolution resolution, const std::vector<Timestamp>& time, const std::vector<double>& price, const std::string& name) : resolution(resolution), name(name) {
+	if (time.size() != price.size()) {
+		throw std::runtime_error("Price and time vectors are not equally sized.");
 	}
 
+	columns = std::make_shared<Columns>(Columns{ time, price });
+
 	sortInternals();
 }
 
-// Copy constructor.
+std::shared_ptr<TimeSeriesTransformations::Columns> TimeSeriesTransformations::emptyColumns() noexcept {
+	static const std::shared_ptr<Columns> empty = std::make_shared<Columns>();
+	return empty;
+}
+
+// Detach from any copies still sharing the columns before they are modified. use_count is a relaxed
+// load, so when it reports sole ownership the fence orders the writes below after the release of the
+// last other owner, which may have been a copy or query destroyed on another thread.
+TimeSeriesTransformations::Columns& TimeSeriesTransformations::writableColumns() {
+	if (columns.use_count() != 1) {
+		columns = std::make_shared<Columns>(*columns);
+	}
+	else {
+		std::atomic_thread_fence(std::memory_order_acquire);
+	}
+	return *columns;
+}
+
+// Copy constructor, the columns are shared rather than copied.
 TimeSeriesTransformations::TimeSeriesTransformations(const TimeSeriesTransformations& TSSObject) {
-	name = TSSObject.getName();
-	separator = TSSObject.getSeparator();
-	timePricePairs = TSSObject.getTimePricePairs();
+	*this = TSSObject;
 }
 
-// Assignment Operator.
+// Move constructor.
+TimeSeriesTransformations::TimeSeriesTransformations(TimeSeriesTransformations&& TSSObject) noexcept {
+	*this = std::move(TSSObject);
+}
+
+// Assignment Operator. The day index is not copied, the copy rebuilds its own if it needs one.
+// The source's aggregates are read under its cacheMutex, as queries on it may be filling them.
 TimeSeriesTransformations& TimeSeriesTransformations::operator=(const TimeSeriesTransformations& TSSObject) {
+	if (this == &TSSObject) {
+		return (*this);
+	}
+
 	this->name = TSSObject.getName();
 	this->separator = TSSObject.getSeparator();
-	this->timePricePairs = TSSObject.getTimePricePairs();
+	this->columns = TSSObject.columns;
+	this->resolution = TSSObject.resolution;
+	{
+		std::lock_guard<std::mutex> lock(TSSObject.cacheMutex);
+		this->priceAggregates = TSSObject.priceAggregates;
+		this->incrementAggregates = TSSObject.incrementAggregates;
+		this->priceAggregatesValid = TSSObject.priceAggregatesValid.load(std::memory_order_relaxed);
+		this->incrementAggregatesValid = TSSObject.incrementAggregatesValid.load(std::memory_order_relaxed);
+	}
+	this->dayIndexValid = false;
+
+	return (*this);
+}
+
+// Move assignment, the source is left as an empty series.
+TimeSeriesTransformations& TimeSeriesTransformations::operator=(TimeSeriesTransformations&& TSSObject) noexcept {
+	if (this == &TSSObject) {
+		return (*this);
+	}
+
+	this->name = std::move(TSSObject.name);
+	this->separator = TSSObject.separator;
+	this->columns = std::exchange(TSSObject.columns, emptyColumns());
+	this->resolution = TSSObject.resolution;
+	this->priceAggregates = TSSObject.priceAggregates;
+	this->incrementAggregates = TSSObject.incrementAggregates;
+	this->priceAggregatesValid = TSSObject.priceAggregatesValid.load();
+	this->incrementAggregatesValid = TSSObject.incrementAggregatesValid.load();
+	this->indexedDays = std::move(TSSObject.indexedDays);
+	this->dayOffsets = std::move(TSSObject.dayOffsets);
+	this->dayIndexValid = TSSObject.dayIndexValid.load();
+
+	TSSObject.name.clear();
+	TSSObject.invalidateCaches();
 
 	return (*this);
 }
@@ -159,159 +454,380 @@ TimeSeriesTransformations& TimeSeriesTransformations::operator=(const TimeSeries
 bool TimeSeriesTransformations::operator==(const TimeSeriesTransformations& TSSObject) const {
 	bool namesEqual = (name == TSSObject.getName());
 	bool separatorEqual = (separator == TSSObject.getSeparator());
-	bool timeAndPriceEqual = (timePricePairs == TSSObject.getTimePricePairs());
+	bool sameColumns = (columns == TSSObject.columns) || (columns->times == TSSObject.columns->times && columns->prices == TSSObject.columns->prices);
+	bool timeAndPriceEqual = (resolution == TSSObject.resolution && sameColumns);
 	return (namesEqual && separatorEqual && timeAndPriceEqual);
 }
 
-// Calculate mean of price.
-bool TimeSeriesTransformations::mean(double* meanValue) const {
-	if (timePricePairs.empty()) {
-		*meanValue = std::numeric_limits<double>::quiet_NaN();
-		return false;
+// Single pass summary of the prices, cached until the series is modified.
+bool TimeSeriesTransformations::summary(SummaryStatistics* stats) const {
+	const std::vector<double>& prices = columns->prices;
+	if (!priceAggregatesValid.load(std::memory_order_acquire)) {
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		if (!priceAggregatesValid.load(std::memory_order_relaxed)) {
+			priceAggregates = summarize(prices);
+			priceAggregatesValid.store(true, std::memory_order_release);
+		}
 	}
 
-	double sum = 0.0;
-	for (const auto& pair : timePricePairs) {
-		sum += pair.second;
-	}
+	*stats = priceAggregates;
+	return !prices.empty();
+}
 
-	*meanValue = sum / timePricePairs.size();
+// Calculate mean of price.
+bool TimeSeriesTransformations::mean(double* meanValue) const {
+	SummaryStatistics stats;
+	bool hasData = summary(&stats);
 
-	return true;
+	*meanValue = stats.mean;
+	return hasData;
 }
 
 // Calculate SD of price.
 bool TimeSeriesTransformations::standardDeviation(double* standardDeviationValue) const {
-	if (timePricePairs.empty()) {
-		*standardDeviationValue = std::numeric_limits<double>::quiet_NaN();
-		return false;
+	SummaryStatistics stats;
+	bool hasData = summary(&stats);
+
+	*standardDeviationValue = std::sqrt(stats.variance);
+	return hasData;
+}
+
+// Single pass summary of the price increments, cached until the series is modified.
+bool TimeSeriesTransformations::incrementSummary(SummaryStatistics* stats) const {
+	const std::vector<double>& prices = columns->prices;
+	if (!incrementAggregatesValid.load(std::memory_order_acquire)) {
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		if (!incrementAggregatesValid.load(std::memory_order_relaxed)) {
+			incrementAggregates = summarizeIncrements(prices);
+			incrementAggregatesValid.store(true, std::memory_order_release);
+		}
 	}
 
-	double meanVal;
-	this->mean(&meanVal);
+	*stats = incrementAggregates;
+	return prices.size() > 1;
+}
 
-	std::vector<double> transformedPrice = getPriceVector();
-	std::for_each(transformedPrice.begin(), transformedPrice.end(), [&](double& i) -> void { i = pow(i - meanVal, 2); });
+void TimeSeriesTransformations::invalidateCaches() noexcept {
+	priceAggregatesValid = false;
+	incrementAggregatesValid = false;
+	dayIndexValid = false;
+}
 
-	if (timePricePairs.empty()) { return 0; }
+// Record where each UTC day holding rows starts, one linear pass over the times.
+void TimeSeriesTransformations::buildDayIndex() const {
+	const std::vector<Timestamp>& times = columns->times;
+	indexedDays.clear();
+	dayOffsets.clear();
 
-	double sum = std::reduce(transformedPrice.begin(), transformedPrice.end(), 0.0);
+	if (times.empty()) { return; }
 
-	*standardDeviationValue = std::sqrt((1.0 / double(timePricePairs.size() - 1)) * sum);
+	const std::int64_t ticksPerDay = secondsPerDay * ticksPerSecond(resolution);
+	for (size_t row = 0; row < times.size(); row++) {
+		std::int64_t day = dayOfTime(times[row], ticksPerDay);
+		if (indexedDays.empty() || indexedDays.back() != day) {
+			indexedDays.push_back(day);
+			dayOffsets.push_back(row);
+		}
+	}
+	dayOffsets.push_back(times.size());
+}
 
-	return true;
+// In order appends only add rows to the last indexed day or start new days after it, so the index
+// is extended in O(new rows) rather than rebuilt by the next day query.
+void TimeSeriesTransformations::extendDayIndex(size_t firstNewRow, bool appendedInOrder) {
+	const std::vector<Timestamp>& times = columns->times;
+	if (!dayIndexValid || !appendedInOrder || dayOffsets.empty()) {
+		dayIndexValid = false;
+		return;
+	}
+
+	const std::int64_t ticksPerDay = secondsPerDay * ticksPerSecond(resolution);
+	dayOffsets.pop_back();
+
+	for (size_t row = firstNewRow; row < times.size(); row++) {
+		std::int64_t day = dayOfTime(times[row], ticksPerDay);
+		if (indexedDays.back() != day) {
+			indexedDays.push_back(day);
+			dayOffsets.push_back(row);
+		}
+	}
+	dayOffsets.push_back(times.size());
 }
 
-// Calculate mean of diff of price.
-bool TimeSeriesTransformations::computeIncrementMean(double* meanValue) const {
-	if (timePricePairs.size() <= 1) {
-		*meanValue = std::numeric_limits<double>::quiet_NaN();
-		return false;
+// Rows [first, last) on the UTC day containing unixEpochTime, a binary search over the indexed days
+// once the index is built.
+std::pair<size_t, size_t> TimeSeriesTransformations::rowsOnDay(Timestamp unixEpochTime) const {
+	if (!dayIndexValid.load(std::memory_order_acquire)) {
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		if (!dayIndexValid.load(std::memory_order_relaxed)) {
+			buildDayIndex();
+			dayIndexValid.store(true, std::memory_order_release);
+		}
 	}
 
-	std::vector<double> priceVector = getPriceVector();
-	std::vector<double> diff = vectorDiff(priceVector);
+	std::int64_t day = dayOfTime(unixEpochTime, secondsPerDay);
+	auto found = std::lower_bound(indexedDays.begin(), indexedDays.end(), day);
+	if (found == indexedDays.end() || *found != day) {
+		return { 0, 0 };
+	}
 
-	std::vector<int> timeIndex(priceVector.size() - 1);
-	std::iota(timeIndex.begin(), timeIndex.end(), 0);
+	size_t position = found - indexedDays.begin();
+	return { dayOffsets[position], dayOffsets[position + 1] };
+}
 
-	TimeSeriesTransformations ts(timeIndex, diff);
-	return ts.mean(meanValue);
+// Rows [first, last) with ticks from the start of firstSecond to the end of lastSecond.
+std::pair<size_t, size_t> TimeSeriesTransformations::rowsInSeconds(Timestamp firstSecond, Timestamp lastSecond) const {
+	const std::vector<Timestamp>& times = columns->times;
+	const Timestamp ticks = ticksPerSecond(resolution);
+	size_t first = std::lower_bound(times.begin(), times.end(), firstSecond * ticks) - times.begin();
+	size_t last = std::lower_bound(times.begin() + first, times.end(), (lastSecond + 1) * ticks) - times.begin();
+	return { first, std::max(first, last) };
 }
 
-// Calculate SD of diff of price.
-bool TimeSeriesTransformations::computeIncrementStandardDeviation(double* standardDeviationValue) const {
-	if (timePricePairs.size() <= 1) {
-		*standardDeviationValue = std::numeric_limits<double>::quiet_NaN();
+TimePriceView TimeSeriesTransformations::pricesOnDay(Timestamp unixEpochTime) const {
+	std::pair<size_t, size_t> rows = rowsOnDay(unixEpochTime);
+	return getView().subview(rows.first, rows.second - rows.first);
+}
+
+TimeSeriesQuery TimeSeriesTransformations::query() const {
+	return TimeSeriesQuery(*this);
+}
+
+// Calculate mean of diff of price. The increments telescope, so this is (last - first) / (n - 1).
+bool TimeSeriesTransformations::computeIncrementMean(double* meanValue) const {
+	const std::vector<double>& prices = columns->prices;
+	if (prices.size() <= 1) {
+		*meanValue = std::numeric_limits<double>::quiet_NaN();
 		return false;
 	}
 
-	std::vector<double> priceVector = getPriceVector();
-	std::vector<double> diff = vectorDiff(priceVector);
+	*meanValue = (prices.back() - prices.front()) / double(prices.size() - 1);
+	return true;
+}
 
-	std::vector<int> timeIndex(priceVector.size() - 1);
-	std::iota(timeIndex.begin(), timeIndex.end(), 0);
+// Calculate SD of diff of price.
+bool TimeSeriesTransformations::computeIncrementStandardDeviation(double* standardDeviationValue) const {
+	SummaryStatistics stats;
+	bool hasData = incrementSummary(&stats);
 
-	TimeSeriesTransformations ts(timeIndex, diff);
-	return ts.standardDeviation(standardDeviationValue);
+	*standardDeviationValue = std::sqrt(stats.variance);
+	return hasData;
 }
 
 void TimeSeriesTransformations::addASharePrice(const std::string& datetime, double price) {
-	int unixEpochTime;
-	if ((!stringDateToUnix(datetime, &unixEpochTime)) || !isDateValid(datetime)) {
+	Timestamp unixEpochTime;
+	if (!parseDateTime(datetime, &unixEpochTime)) {
 		throw std::invalid_argument("Date " + datetime + " cannot be parsed.");
 	}
 
-	timePricePairs.emplace_back(unixEpochTime, price);
-	sortInternals();
+	addASharePrice(unixEpochTime, price);
+}
+
+void TimeSeriesTransformations::addASharePrice(Timestamp unixEpochTime, double price) {
+	addTick(unixEpochTime * ticksPerSecond(resolution), price);
+}
+
+void TimeSeriesTransformations::addTick(Timestamp time, double price) {
+	Columns& owned = writableColumns();
+	std::vector<Timestamp>& times = owned.times;
+	std::vector<double>& prices = owned.prices;
+	bool appendsInOrder = times.empty() || times.back() <= time;
+	double previousLastPrice = prices.empty() ? 0.0 : prices.back();
+
+	// In order ticks are a plain O(1) append, late ones are placed by binary search after any equal times.
+	if (appendsInOrder) {
+		times.push_back(time);
+		prices.push_back(price);
+	}
+	else {
+		size_t position = std::upper_bound(times.begin(), times.end(), time) - times.begin();
+		times.insert(times.begin() + position, time);
+		prices.insert(prices.begin() + position, price);
+	}
+
+	// Keep the cached aggregates current, only an out of order tick changes the increments.
+	if (priceAggregatesValid) {
+		accumulate(&priceAggregates, price);
+	}
+
+	if (incrementAggregatesValid && appendsInOrder && prices.size() > 1) {
+		accumulate(&incrementAggregates, price - previousLastPrice);
+		incrementAggregates.sum = prices.back() - prices.front();
+	}
+	else {
+		incrementAggregatesValid = false;
+	}
+
+	extendDayIndex(times.size() - 1, appendsInOrder);
+}
+
+void TimeSeriesTransformations::addSharePrices(const std::vector<int>& timeVec, const std::vector<double>& priceVec) {
+	const Timestamp ticks = ticksPerSecond(resolution);
+	std::vector<Timestamp> tickVec(timeVec.size());
+	std::transform(timeVec.begin(), timeVec.end(), tickVec.begin(), [ticks](int time) { return time * ticks; });
+
+	addTicks(tickVec, priceVec);
+}
+
+// Append a block of ticks, sorting only the block and merging it into the series once.
+void TimeSeriesTransformations::addTicks(const std::vector<Timestamp>& timeVec, const std::vector<double>& priceVec) {
+	if (timeVec.size() != priceVec.size()) {
+		throw std::runtime_error("Price and time vectors are not equally sized.");
+	}
+
+	// Only detach shared columns once rows will actually be appended.
+	if (timeVec.empty()) { return; }
+
+	Columns& owned = writableColumns();
+	std::vector<Timestamp>& times = owned.times;
+	std::vector<double>& prices = owned.prices;
+	size_t previousSize = times.size();
+
+	times.insert(times.end(), timeVec.begin(), timeVec.end());
+	prices.insert(prices.end(), priceVec.begin(), priceVec.end());
+
+	sortRowsByTime(times, prices, previousSize, times.size());
+	bool appendsInOrder = previousSize == 0 || times[previousSize - 1] <= times[previousSize];
+	mergeSortedRuns({ previousSize, times.size() });
+
+	if (priceAggregatesValid) {
+		priceAggregates = mergeSummaries(priceAggregates, summarize(priceVec));
+	}
+
+	if (incrementAggregatesValid && appendsInOrder && previousSize > 0) {
+		// The new increments start from the previous last price.
+		std::span<const double> newPrices = std::span<const double>(prices).subspan(previousSize - 1);
+		incrementAggregates = mergeSummaries(incrementAggregates, summarizeIncrements(newPrices));
+		incrementAggregates.sum = prices.back() - prices.front();
+	}
+	else {
+		incrementAggregatesValid = false;
+	}
+
+	extendDayIndex(previousSize, appendsInOrder);
 }
 
 bool TimeSeriesTransformations::removeEntryAtTime(const std::string& time) {
-	int unixEpochTime;
-	if ((!stringDateToUnix(time, &unixEpochTime)) || !isDateValid(time)) {
+	Timestamp unixEpochTime;
+	if (!parseDateTime(time, &unixEpochTime)) {
 		return false;
 	}
 
-	return std::erase_if(timePricePairs, [unixEpochTime](const auto& pair) { return (pair.first == unixEpochTime); });
+	return removeEntryAtTime(unixEpochTime);
+}
+
+bool TimeSeriesTransformations::removeEntryAtTime(Timestamp unixEpochTime) {
+	std::pair<size_t, size_t> matches = rowsInSeconds(unixEpochTime, unixEpochTime);
+	return eraseRange(matches.first, matches.second);
 }
 
 bool TimeSeriesTransformations::removePricesBefore(const std::string& date) {
-	int unixEpochTime;
-	if ((!stringDateToUnix(date, &unixEpochTime)) || !isDateValid(date)) {
+	Timestamp unixEpochTime;
+	if (!parseDateTime(date, &unixEpochTime)) {
 		return false;
 	}
-	return std::erase_if(timePricePairs, [unixEpochTime](const auto& pair) { return (pair.first < unixEpochTime); });
+
+	return removePricesBefore(unixEpochTime);
+}
+
+bool TimeSeriesTransformations::removePricesBefore(Timestamp unixEpochTime) {
+	return eraseRange(0, rowsInSeconds(unixEpochTime, unixEpochTime).first);
 }
 
 bool TimeSeriesTransformations::removePricesGreaterThan(double priceCondition) {
-	return std::erase_if(timePricePairs, [priceCondition](const auto& pair) { return (pair.second > priceCondition); });
+	return eraseRowsWhere([priceCondition](Timestamp, double price) { return (price > priceCondition); });
 }
 
 bool TimeSeriesTransformations::removePricesLowerThan(double priceCondition) {
-	return std::erase_if(timePricePairs, [priceCondition](const auto& pair) { return (pair.second < priceCondition); });
+	return eraseRowsWhere([priceCondition](Timestamp, double price) { return (price < priceCondition); });
 }
 
 bool TimeSeriesTransformations::removePricesAfter(const std::string& date) {
-	int unixEpochTime;
-	if ((!stringDateToUnix(date, &unixEpochTime)) || !isDateValid(date)) {
+	Timestamp unixEpochTime;
+	if (!parseDateTime(date, &unixEpochTime)) {
 		return false;
 	}
-	return std::erase_if(timePricePairs, [unixEpochTime](const auto& pair) { return (pair.first > unixEpochTime); });
+
+	return removePricesAfter(unixEpochTime);
 }
 
-std::string TimeSeriesTransformations::printSharePricesOnDate(const std::string& date) const {
-	std::string truncatedDate = std::string(date.begin(), date.begin() + 10);
-	int unixEpochTime;
-	// I'm deliberately leaving IsDateValid with date so it will still error if you put in an invalid date.
-	if ((!stringDateToUnix(truncatedDate, &unixEpochTime)) || !isDateValid(date)) {
-		throw std::invalid_argument("Date " + date + " cannot be parsed.");
+bool TimeSeriesTransformations::removePricesAfter(Timestamp unixEpochTime) {
+	const std::vector<Timestamp>& times = columns->times;
+	return eraseRange(rowsInSeconds(unixEpochTime, unixEpochTime).second, times.size());
+}
+
+// Erase the contiguous rows [first, last) from both columns. Returns whether anything was removed.
+bool TimeSeriesTransformations::eraseRange(size_t first, size_t last) {
+	// Checked before detaching, so a copy that removes nothing keeps sharing its columns.
+	if (first >= last) {
+		return false;
 	}
 
-	TimeSeriesTransformations v(getTimeVector(), getPriceVector());
+	Columns& owned = writableColumns();
+	std::vector<Timestamp>& times = owned.times;
+	std::vector<double>& prices = owned.prices;
+
+	times.erase(times.begin() + first, times.begin() + last);
+	prices.erase(prices.begin() + first, prices.begin() + last);
+	invalidateCaches();
+
+	return true;
+}
 
-	v.removePricesBefore(date);
+// View of the rows from startDate to endDate inclusive, located by binary search.
+TimePriceView TimeSeriesTransformations::sliceBetween(const std::string& startDate, const std::string& endDate) const {
+	Timestamp startTime, endTime;
+	if (!parseDateTime(startDate, &startTime)) {
+		throw std::invalid_argument("Date " + startDate + " cannot be parsed.");
+	}
+	if (!parseDateTime(endDate, &endTime)) {
+		throw std::invalid_argument("Date " + endDate + " cannot be parsed.");
+	}
 
-	// Recall that 86400 seconds in a day and removePricesAfter retains the passed in date (hence 86400-1).
-	v.removePricesAfter(unixEpochToString(unixEpochTime + 86400 - 1));
+	return sliceBetween(startTime, endTime);
+}
 
-	std::string stringOfPrices = "";
+TimePriceView TimeSeriesTransformations::sliceBetween(Timestamp startTime, Timestamp endTime) const {
+	std::pair<size_t, size_t> rows = rowsInSeconds(startTime, endTime);
+	return getView().subview(rows.first, rows.second - rows.first);
+}
 
-	for (auto const i : v.getPriceVector()) {
-		stringOfPrices += std::to_string(i) + "\n";
+std::string TimeSeriesTransformations::printSharePricesOnDate(const std::string& date) const {
+	Timestamp startTime;
+	if (!parseDateTime(date, &startTime)) {
+		throw std::invalid_argument("Date " + date + " cannot be parsed.");
 	}
 
-	return stringOfPrices;
+	return printSharePricesOnDate(startTime);
+}
+
+// Prices from startTime to the end of its UTC day.
+std::string TimeSeriesTransformations::printSharePricesOnDate(Timestamp startTime) const {
+	const std::vector<Timestamp>& times = columns->times;
+	const std::vector<double>& prices = columns->prices;
+	std::pair<size_t, size_t> rows = rowsOnDay(startTime);
+	// Only a start part way through the day needs a search, and only within that day.
+	rows.first = std::lower_bound(times.begin() + rows.first, times.begin() + rows.second, startTime * ticksPerSecond(resolution)) - times.begin();
+
+	return formatValueLines(rows.first, rows.second, [&prices](size_t i) { return prices[i]; });
 }
 
 bool TimeSeriesTransformations::getPriceAtDate(const std::string& date, double* value) const {
-	int unixEpochTime;
-	if ((!stringDateToUnix(date, &unixEpochTime)) || !isDateValid(date)) {
+	Timestamp unixEpochTime;
+	if (!parseDateTime(date, &unixEpochTime)) {
 		*value = std::numeric_limits<double>::quiet_NaN();
 		return false;
 	}
 
-	for (auto const& pair : timePricePairs) {
-		if (pair.first == unixEpochTime) { *value = pair.second; return true; }
+	return getPriceAtDate(unixEpochTime, value);
+}
+
+bool TimeSeriesTransformations::getPriceAtDate(Timestamp unixEpochTime, double* value) const {
+	const std::vector<double>& prices = columns->prices;
+	std::pair<size_t, size_t> matches = rowsInSeconds(unixEpochTime, unixEpochTime);
+	if (matches.first != matches.second) {
+		*value = prices[matches.first];
+		return true;
 	}
 
 	*value = std::numeric_limits<double>::quiet_NaN();
@@ -319,89 +835,613 @@ bool TimeSeriesTransformations::getPriceAtDate(const std::string& date, double*
 }
 
 std::string TimeSeriesTransformations::printIncrementsOnDate(const std::string& date) const {
-	if (!isDateValid(date)) {
+	Timestamp unixEpochTime;
+	if (!parseDateTime(date, &unixEpochTime)) {
 		throw std::invalid_argument("Date " + date + " cannot be parsed.");
 	}
 
-	if (timePricePairs.size() <= 1) { return ""; }
+	return printIncrementsOnDate(unixEpochTime);
+}
 
-	std::vector<double> priceVecDiff = vectorDiff(getPriceVector());
-	std::vector<int> timeVecDiff = getTimeVector();
-	timeVecDiff.erase(timeVecDiff.begin());
+// Increments from startTime to the end of its UTC day, each taken at the later tick's time.
+std::string TimeSeriesTransformations::printIncrementsOnDate(Timestamp startTime) const {
+	const std::vector<Timestamp>& times = columns->times;
+	const std::vector<double>& prices = columns->prices;
+	std::pair<size_t, size_t> rows = rowsOnDay(startTime);
+	rows.first = std::lower_bound(times.begin() + rows.first, times.begin() + rows.second, startTime * ticksPerSecond(resolution)) - times.begin();
+	// The first tick of the series has no increment.
+	rows.first = std::max<size_t>(rows.first, 1);
+	rows.second = std::max(rows.first, rows.second);
+
+	return formatValueLines(rows.first, rows.second, [&prices](size_t i) { return prices[i] - prices[i - 1]; });
+}
 
-	TimeSeriesTransformations TSSObject(timeVecDiff, priceVecDiff);
+bool TimeSeriesTransformations::findGreatestIncrements(double* priceIncrement) const {
+	SummaryStatistics stats;
+	bool hasData = incrementSummary(&stats);
 
-	return TSSObject.printSharePricesOnDate(date);
+	*priceIncrement = stats.max;
+	return hasData;
 }
 
-bool TimeSeriesTransformations::findGreatestIncrements(double* priceIncrement) const {
-	if (timePricePairs.size() <= 1) {
-		*priceIncrement = std::numeric_limits<double>::quiet_NaN();
-		return false;
+RollingStatistics TimeSeriesTransformations::rollingOverRows(size_t windowRows) const {
+	const std::vector<double>& prices = columns->prices;
+	if (windowRows == 0) {
+		throw std::invalid_argument("Rolling window must hold at least one row.");
 	}
 
-	std::vector<double> increments = vectorDiff(getPriceVector());
+	return rollingStatistics(prices, windowRows);
+}
 
-	*priceIncrement = *std::max_element(increments.begin(), increments.end());
-	return true;
+RollingStatistics TimeSeriesTransformations::rollingOverSeconds(Timestamp windowSeconds) const {
+	const std::vector<Timestamp>& times = columns->times;
+	const std::vector<double>& prices = columns->prices;
+	if (windowSeconds <= 0) {
+		throw std::invalid_argument("Rolling window must be at least one second long.");
+	}
+
+	return rollingStatistics(times, prices, windowSeconds * ticksPerSecond(resolution));
+}
+
+OhlcBars TimeSeriesTransformations::resample(Timestamp bucketSeconds) const {
+	const std::vector<Timestamp>& times = columns->times;
+	const std::vector<double>& prices = columns->prices;
+	if (bucketSeconds <= 0) {
+		throw std::invalid_argument("Bars must be at least one second long.");
+	}
+
+	return resampleOhlc(times, prices, bucketSeconds * ticksPerSecond(resolution));
+}
+
+void appendAlignedRow(AlignedSeries* aligned, Timestamp time, double left, double right) {
+	aligned->times.push_back(time);
+	aligned->left.push_back(left);
+	aligned->right.push_back(right);
+}
+
+// Merge two sorted time columns. Runs of equal times present on both sides are cross joined,
+// rows only on one side are kept when keepUnmatched is set with NaN for the missing price.
+AlignedSeries mergeJoin(std::span<const Timestamp> leftTimes, std::span<const double> leftPrices,
+	std::span<const Timestamp> rightTimes, std::span<const double> rightPrices, bool keepUnmatched) {
+	const double missing = std::numeric_limits<double>::quiet_NaN();
+	AlignedSeries aligned;
+	size_t expectedRows = keepUnmatched ? leftTimes.size() + rightTimes.size() : std::min(leftTimes.size(), rightTimes.size());
+	aligned.times.reserve(expectedRows);
+	aligned.left.reserve(expectedRows);
+	aligned.right.reserve(expectedRows);
+
+	size_t left = 0, right = 0;
+	while (left < leftTimes.size() && right < rightTimes.size()) {
+		if (leftTimes[left] < rightTimes[right]) {
+			if (keepUnmatched) { appendAlignedRow(&aligned, leftTimes[left], leftPrices[left], missing); }
+			left++;
+		}
+		else if (rightTimes[right] < leftTimes[left]) {
+			if (keepUnmatched) { appendAlignedRow(&aligned, rightTimes[right], missing, rightPrices[right]); }
+			right++;
+		}
+		else {
+			Timestamp time = leftTimes[left];
+			size_t leftEnd = left, rightEnd = right;
+			while (leftEnd < leftTimes.size() && leftTimes[leftEnd] == time) { leftEnd++; }
+			while (rightEnd < rightTimes.size() && rightTimes[rightEnd] == time) { rightEnd++; }
+
+			for (size_t i = left; i < leftEnd; i++) {
+				for (size_t j = right; j < rightEnd; j++) {
+					appendAlignedRow(&aligned, time, leftPrices[i], rightPrices[j]);
+				}
+			}
+
+			left = leftEnd;
+			right = rightEnd;
+		}
+	}
+
+	if (keepUnmatched) {
+		for (; left < leftTimes.size(); left++) { appendAlignedRow(&aligned, leftTimes[left], leftPrices[left], missing); }
+		for (; right < rightTimes.size(); right++) { appendAlignedRow(&aligned, rightTimes[right], missing, rightPrices[right]); }
+	}
+
+	return aligned;
+}
+
+void checkSameResolution(TimeResolution left, TimeResolution right) {
+	if (left != right) {
+		throw std::invalid_argument("Series with different time resolutions cannot be joined.");
+	}
+}
+
+// A single forward walk of other, both columns are already sorted by time.
+AlignedSeries TimeSeriesTransformations::asOfJoin(const TimeSeriesTransformations& other) const {
+	const std::vector<Timestamp>& times = columns->times;
+	const std::vector<double>& prices = columns->prices;
+	checkSameResolution(resolution, other.resolution);
+
+	AlignedSeries aligned;
+	aligned.times = times;
+	aligned.left = prices;
+	aligned.right.resize(times.size());
+
+	size_t right = 0;
+	for (size_t i = 0; i < times.size(); i++) {
+		while (right < other.columns->times.size() && other.columns->times[right] <= times[i]) {
+			right++;
+		}
+		aligned.right[i] = (right > 0) ? other.columns->prices[right - 1] : std::numeric_limits<double>::quiet_NaN();
+	}
+
+	return aligned;
+}
+
+AlignedSeries TimeSeriesTransformations::innerJoin(const TimeSeriesTransformations& other) const {
+	const std::vector<Timestamp>& times = columns->times;
+	const std::vector<double>& prices = columns->prices;
+	checkSameResolution(resolution, other.resolution);
+	return mergeJoin(times, prices, other.columns->times, other.columns->prices, false);
+}
+
+AlignedSeries TimeSeriesTransformations::outerJoin(const TimeSeriesTransformations& other) const {
+	const std::vector<Timestamp>& times = columns->times;
+	const std::vector<double>& prices = columns->prices;
+	checkSameResolution(resolution, other.resolution);
+	return mergeJoin(times, prices, other.columns->times, other.columns->prices, true);
 }
 
 std::string TimeSeriesTransformations::getName() const noexcept {
 	return name;
 }
 
+// Order by time, skipping the sort entirely when the data is already in order.
 void TimeSeriesTransformations::sortInternals() {
-	std::sort(timePricePairs.begin(), timePricePairs.end(), [](const auto& left, const auto& right) {
-		return left.first < right.first;
-		});
+	Columns& owned = writableColumns();
+	std::vector<Timestamp>& times = owned.times;
+	std::vector<double>& prices = owned.prices;
+	sortRowsByTime(times, prices, 0, times.size());
 }
 
-std::vector<std::pair<int, double>> TimeSeriesTransformations::getTimePricePairs() const noexcept {
+// Stable merge of the adjacent sorted runs [start, middle) and [middle, end) of both columns.
+void mergeAdjacentRuns(std::vector<Timestamp>& times, std::vector<double>& prices, size_t start, size_t middle, size_t end) {
+	// Left rows up to the first right time are already in place, only the overlapping suffix moves.
+	start = std::upper_bound(times.begin() + start, times.begin() + middle, times[middle]) - times.begin();
+	std::vector<Timestamp> leftTimes(times.begin() + start, times.begin() + middle);
+	std::vector<double> leftPrices(prices.begin() + start, prices.begin() + middle);
+
+	size_t left = 0;
+	size_t right = middle;
+	size_t output = start;
+
+	while (left < leftTimes.size() && right < end) {
+		if (times[right] < leftTimes[left]) {
+			times[output] = times[right];
+			prices[output++] = prices[right++];
+		}
+		else {
+			times[output] = leftTimes[left];
+			prices[output++] = leftPrices[left++];
+		}
+	}
+
+	while (left < leftTimes.size()) {
+		times[output] = leftTimes[left];
+		prices[output++] = leftPrices[left++];
+	}
+}
+
+// Merge consecutive runs that are each already in time order, runEnds holds the end index of every run.
+void TimeSeriesTransformations::mergeSortedRuns(std::vector<size_t> runEnds) {
+	Columns& owned = writableColumns();
+	std::vector<Timestamp>& times = owned.times;
+	std::vector<double>& prices = owned.prices;
+	// Runs that continue in order from the previous one need no merging.
+	std::vector<size_t> unorderedRunEnds;
+	for (size_t i = 0; i < runEnds.size(); i++) {
+		size_t end = runEnds[i];
+		bool continuesInOrder = i + 1 < runEnds.size() && end > 0 && end < runEnds[i + 1] && times[end - 1] <= times[end];
+
+		if (!continuesInOrder && (unorderedRunEnds.empty() || unorderedRunEnds.back() != end)) {
+			unorderedRunEnds.push_back(end);
+		}
+	}
+
+	// Merge neighbouring runs pairwise until a single run remains, log2(k) passes in total.
+	while (unorderedRunEnds.size() > 1) {
+		std::vector<size_t> mergedRunEnds;
+		size_t start = 0;
+
+		for (size_t i = 0; i < unorderedRunEnds.size(); i += 2) {
+			if (i + 1 < unorderedRunEnds.size()) {
+				mergeAdjacentRuns(times, prices, start, unorderedRunEnds[i], unorderedRunEnds[i + 1]);
+				start = unorderedRunEnds[i + 1];
+			}
+			else {
+				start = unorderedRunEnds[i];
+			}
+			mergedRunEnds.push_back(start);
+		}
+
+		unorderedRunEnds = std::move(mergedRunEnds);
+	}
+}
+
+std::vector<std::pair<int, double>> TimeSeriesTransformations::getTimePricePairs() const {
+	const std::vector<Timestamp>& times = columns->times;
+	const std::vector<double>& prices = columns->prices;
+	std::vector<std::pair<int, double>> timePricePairs;
+	timePricePairs.reserve(times.size());
+
+	for (size_t i = 0; i < times.size(); i++) {
+		timePricePairs.emplace_back(checkedInt(times[i]), prices[i]);
+	}
+
 	return timePricePairs;
 }
 
+TimeResolution TimeSeriesTransformations::getResolution() const noexcept {
+	return resolution;
+}
+
 size_t TimeSeriesTransformations::count() const noexcept {
-	return timePricePairs.size();
+	const std::vector<Timestamp>& times = columns->times;
+	return times.size();
 }
 
 char TimeSeriesTransformations::getSeparator() const noexcept {
 	return separator;
 }
 
-void TimeSeriesTransformations::saveData(const std::string& filename) const
-{
+void TimeSeriesTransformations::saveData(const std::string& filename) const {
+	saveData(filename, decimalPlaces);
+}
+
+// Format a price with a fixed number of decimal places, dropping trailing zeros.
+char* formatPrice(char* first, char* last, double price, int precision) {
+	char* end = std::to_chars(first, last, price, std::chars_format::fixed, precision).ptr;
+
+	if (precision > 0 && std::find(first, end, '.') != end) {
+		while (end[-1] == '0') { end--; }
+		if (end[-1] == '.') { end--; }
+	}
+
+	return end;
+}
+
+// Rows are formatted with to_chars into one reusable buffer which is written out in large blocks.
+void TimeSeriesTransformations::saveData(const std::string& filename, int precision) const {
+	const std::vector<Timestamp>& times = columns->times;
+	const std::vector<double>& prices = columns->prices;
 	std::ofstream newCSV;
 
 	newCSV.open(filename);
 
 	if (newCSV.is_open()) {
-		// Adds header to csv.
-		newCSV << "TIMESTAMP" << this->getSeparator() << name << std::endl;
+		const size_t bufferSize = 1 << 20;
+		// Longest possible row: a 64 bit time, the separator and a fixed double with up to 17 decimals.
+		const size_t maximumRowSize = 512;
+		precision = std::clamp(precision, 0, 17);
+
+		std::vector<char> buffer(bufferSize);
+		char* position = buffer.data();
+		char* bufferEnd = buffer.data() + bufferSize;
 
-		for (const auto& pair : timePricePairs) {
-			newCSV << pair.first << separator << pair.second << std::endl;
+		// Adds header to csv.
+		std::string header = "TIMESTAMP" + std::string(1, this->getSeparator()) + name + "\n";
+		newCSV.write(header.data(), header.size());
+
+		for (size_t i = 0; i < times.size(); i++) {
+			if (static_cast<size_t>(bufferEnd - position) < maximumRowSize) {
+				newCSV.write(buffer.data(), position - buffer.data());
+				position = buffer.data();
+			}
+
+			position = std::to_chars(position, bufferEnd, times[i]).ptr;
+			*position++ = separator;
+			position = formatPrice(position, bufferEnd, prices[i], precision);
+			*position++ = '\n';
 		}
+
+		newCSV.write(buffer.data(), position - buffer.data());
 		newCSV.close();
 	}
 }
 
 std::vector<double> TimeSeriesTransformations::getPriceVector() const {
+	const std::vector<double>& prices = columns->prices;
+	return prices;
+}
+
+std::vector<int> TimeSeriesTransformations::getTimeVector() const {
+	const std::vector<Timestamp>& times = columns->times;
+	std::vector<int> timeVec(times.size());
+	std::transform(times.begin(), times.end(), timeVec.begin(), checkedInt);
+	return timeVec;
+}
+
+std::vector<Timestamp> TimeSeriesTransformations::getTimestampVector() const {
+	const std::vector<Timestamp>& times = columns->times;
+	return times;
+}
+
+std::span<const double> TimeSeriesTransformations::getPriceView() const noexcept {
+	const std::vector<double>& prices = columns->prices;
+	return prices;
+}
+
+std::span<const Timestamp> TimeSeriesTransformations::getTimeView() const noexcept {
+	const std::vector<Timestamp>& times = columns->times;
+	return times;
+}
+
+TimePriceView TimeSeriesTransformations::getView() const noexcept {
+	const std::vector<Timestamp>& times = columns->times;
+	const std::vector<double>& prices = columns->prices;
+	return TimePriceView(times, prices);
+}
 
-	std::vector<double> priceVec{};
+// Binary snapshot layout. All values are native endian, every section starts on an 8 byte boundary:
+// header, name (padded), time column (padded), double price column. Version 1 stored int32 seconds,
+// version 2 stores int64 ticks and their resolution in a byte version 1 left as zero (seconds).
+struct BinaryHeader {
+	char magic[4];
+	std::uint32_t version;
+	std::uint64_t count;
+	std::int64_t minTime;
+	std::int64_t maxTime;
+	std::uint32_t nameLength;
+	char separator;
+	char resolution;
+	char reserved[2];
+};
+
+const char binaryMagic[4] = { 'T', 'S', 'T', 'B' };
+const std::uint32_t binaryVersion = 2;
+
+size_t paddedTo8(size_t bytes) {
+	return (bytes + 7) & ~size_t(7);
+}
+
+void TimeSeriesTransformations::saveBinary(const std::string& filename) const {
+	const std::vector<Timestamp>& times = columns->times;
+	const std::vector<double>& prices = columns->prices;
+	std::ofstream file(filename, std::ios::binary);
 
-	for (const auto& element : timePricePairs) {
-		priceVec.push_back(element.second);
+	if (!file.is_open()) {
+		throw std::runtime_error("Unable to open file " + filename);
 	}
 
-	return priceVec;
+	BinaryHeader header{};
+	std::memcpy(header.magic, binaryMagic, sizeof(binaryMagic));
+	header.version = binaryVersion;
+	header.count = times.size();
+	header.minTime = times.empty() ? 0 : times.front();
+	header.maxTime = times.empty() ? 0 : times.back();
+	header.nameLength = static_cast<std::uint32_t>(name.size());
+	header.separator = separator;
+	header.resolution = static_cast<char>(resolution);
+
+	const char padding[8] = {};
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(name.data(), name.size());
+	file.write(padding, paddedTo8(name.size()) - name.size());
+
+	size_t timeBytes = times.size() * sizeof(Timestamp);
+	file.write(reinterpret_cast<const char*>(times.data()), timeBytes);
+	file.write(padding, paddedTo8(timeBytes) - timeBytes);
+	file.write(reinterpret_cast<const char*>(prices.data()), prices.size() * sizeof(double));
+
+	if (!file) {
+		throw std::runtime_error("Unable to write file " + filename);
+	}
 }
 
-std::vector<int> TimeSeriesTransformations::getTimeVector() const {
-	std::vector<int> timeVec{};
+// Load a binary snapshot. The columns are copied out of the file with memcpy, nothing is parsed, and
+// the buffer need not be aligned. Times must be sorted and match the header range, as every lookup
+// relies on it.
+TimeSeriesTransformations TimeSeriesTransformations::loadBinary(const std::string& filenameAndPath) {
+	MappedFile mapped(filenameAndPath);
+	std::string streamBuffer;
+
+	const char* first = mapped.data();
+	size_t size = mapped.size();
+
+	if (!mapped.isMapped()) {
+		std::ifstream file(filenameAndPath, std::ios::binary);
 
-	for (const auto& element : timePricePairs) {
-		timeVec.push_back(element.first);
+		if (!file.is_open()) {
+			throw std::runtime_error("Unable to open file " + filenameAndPath);
+		}
+
+		streamBuffer = readWholeFile(file);
+		first = streamBuffer.data();
+		size = streamBuffer.size();
 	}
 
-	return timeVec;
+	const std::string invalidFile = filenameAndPath + " is not a valid binary time series file.";
+
+	BinaryHeader header;
+	if (size < sizeof(header)) {
+		throw std::runtime_error(invalidFile);
+	}
+	std::memcpy(&header, first, sizeof(header));
+
+	if (std::memcmp(header.magic, binaryMagic, sizeof(binaryMagic)) != 0 || header.version < 1 || header.version > binaryVersion) {
+		throw std::runtime_error(invalidFile);
+	}
+
+	if (header.resolution < static_cast<char>(TimeResolution::Seconds) || header.resolution > static_cast<char>(TimeResolution::Nanoseconds)) {
+		throw std::runtime_error(invalidFile);
+	}
+
+	size_t timeSize = (header.version == 1) ? sizeof(std::int32_t) : sizeof(Timestamp);
+
+	if (header.count > size / sizeof(double) || header.nameLength > size) {
+		throw std::runtime_error(invalidFile);
+	}
+
+	size_t nameOffset = sizeof(header);
+	size_t timeOffset = nameOffset + paddedTo8(header.nameLength);
+	size_t priceOffset = timeOffset + paddedTo8(header.count * timeSize);
+
+	if (priceOffset + header.count * sizeof(double) > size) {
+		throw std::runtime_error(invalidFile);
+	}
+
+	TimeSeriesTransformations series;
+	series.name.assign(first + nameOffset, header.nameLength);
+	series.separator = header.separator;
+	series.resolution = static_cast<TimeResolution>(header.resolution);
+
+	Columns& loaded = series.writableColumns();
+	loaded.times.resize(header.count);
+	loaded.prices.resize(header.count);
+
+	if (header.version == 1) {
+		std::vector<std::int32_t> narrowTimes(header.count);
+		std::memcpy(narrowTimes.data(), first + timeOffset, header.count * sizeof(std::int32_t));
+		std::copy(narrowTimes.begin(), narrowTimes.end(), loaded.times.begin());
+	}
+	else {
+		std::memcpy(loaded.times.data(), first + timeOffset, header.count * sizeof(Timestamp));
+	}
+	std::memcpy(loaded.prices.data(), first + priceOffset, header.count * sizeof(double));
+
+	if (!std::is_sorted(loaded.times.begin(), loaded.times.end())) {
+		throw std::runtime_error(invalidFile);
+	}
+
+	if (!loaded.times.empty() && (loaded.times.front() != header.minTime || loaded.times.back() != header.maxTime)) {
+		throw std::runtime_error(invalidFile);
+	}
+
+	return series;
+}
+
+TimeSeriesQuery::TimeSeriesQuery(const TimeSeriesTransformations& series) : columns(series.columns), resolution(series.resolution), name(series.name) { }
+
+TimeSeriesQuery& TimeSeriesQuery::after(Timestamp unixEpochTime) {
+	firstTime = std::max(firstTime, unixEpochTime * ticksPerSecond(resolution));
+	return *this;
+}
+
+TimeSeriesQuery& TimeSeriesQuery::before(Timestamp unixEpochTime) {
+	lastTime = std::min(lastTime, (unixEpochTime + 1) * ticksPerSecond(resolution) - 1);
+	return *this;
+}
+
+TimeSeriesQuery& TimeSeriesQuery::after(const std::string& date) {
+	Timestamp unixEpochTime;
+	if (!parseDateTime(date, &unixEpochTime)) {
+		throw std::invalid_argument("Date " + date + " cannot be parsed.");
+	}
+
+	return after(unixEpochTime);
+}
+
+TimeSeriesQuery& TimeSeriesQuery::before(const std::string& date) {
+	Timestamp unixEpochTime;
+	if (!parseDateTime(date, &unixEpochTime)) {
+		throw std::invalid_argument("Date " + date + " cannot be parsed.");
+	}
+
+	return before(unixEpochTime);
+}
+
+TimeSeriesQuery& TimeSeriesQuery::priceBelow(double price) {
+	highestPrice = std::min(highestPrice, price);
+	return *this;
+}
+
+TimeSeriesQuery& TimeSeriesQuery::priceAbove(double price) {
+	lowestPrice = std::max(lowestPrice, price);
+	return *this;
+}
+
+TimePriceView TimeSeriesQuery::rowsInTimeBounds() const noexcept {
+	return TimePriceView(columns->times, columns->prices).between(firstTime, lastTime);
+}
+
+bool TimeSeriesQuery::hasPriceBounds() const noexcept {
+	return lowestPrice != -std::numeric_limits<double>::infinity() || highestPrice != std::numeric_limits<double>::infinity();
+}
+
+// Written as the negation of the removal filters so NaN prices are kept exactly when they would be.
+bool TimeSeriesQuery::keepsPrice(double price) const noexcept {
+	return !(price > highestPrice) && !(price < lowestPrice);
+}
+
+size_t TimeSeriesQuery::count() const noexcept {
+	std::span<const double> prices = rowsInTimeBounds().getPriceView();
+	if (!hasPriceBounds()) {
+		return prices.size();
+	}
+
+	return std::count_if(prices.begin(), prices.end(), [this](double price) { return keepsPrice(price); });
+}
+
+// Without price bounds the time range is summarized in place. Otherwise the kept prices are gathered
+// into a small stack buffer that is summarized and merged each time it fills, so the vectorised
+// summary kernel still does the arithmetic and nothing is allocated.
+bool TimeSeriesQuery::summary(SummaryStatistics* stats) const noexcept {
+	std::span<const double> prices = rowsInTimeBounds().getPriceView();
+	if (!hasPriceBounds()) {
+		*stats = summarize(prices);
+		return !prices.empty();
+	}
+
+	const size_t bufferSize = 512;
+	double buffer[bufferSize];
+	size_t buffered = 0;
+	SummaryStatistics result;
+
+	for (double price : prices) {
+		buffer[buffered] = price;
+		buffered += keepsPrice(price);
+
+		if (buffered == bufferSize) {
+			result = mergeSummaries(result, summarize(std::span<const double>(buffer, buffered)));
+			buffered = 0;
+		}
+	}
+	result = mergeSummaries(result, summarize(std::span<const double>(buffer, buffered)));
+
+	*stats = result;
+	return result.count != 0;
+}
+
+bool TimeSeriesQuery::mean(double* meanValue) const noexcept {
+	SummaryStatistics stats;
+	bool hasData = summary(&stats);
+
+	*meanValue = stats.mean;
+	return hasData;
+}
+
+bool TimeSeriesQuery::standardDeviation(double* standardDeviationValue) const noexcept {
+	SummaryStatistics stats;
+	bool hasData = summary(&stats);
+
+	*standardDeviationValue = std::sqrt(stats.variance);
+	return hasData;
+}
+
+TimeSeriesTransformations TimeSeriesQuery::materialize() const {
+	TimePriceView rows = rowsInTimeBounds();
+	std::span<const Timestamp> times = rows.getTimeView();
+	std::span<const double> prices = rows.getPriceView();
+
+	TimeSeriesTransformations result;
+	result.name = name;
+	result.resolution = resolution;
+	TimeSeriesTransformations::Columns& kept = result.writableColumns();
+	kept.times.reserve(hasPriceBounds() ? count() : times.size());
+	kept.prices.reserve(kept.times.capacity());
+
+	for (size_t i = 0; i < times.size(); i++) {
+		if (keepsPrice(prices[i])) {
+			kept.times.push_back(times[i]);
+			kept.prices.push_back(prices[i]);
+		}
+	}
+
+	return result;
 }
@@ -4,6 +4,15 @@
 #include <utility>
 #include <set>
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <span>
+#include <algorithm>
+#include <iterator>
+#include <cstddef>
+#include <limits>
+#include "TimeSeriesKernels.h"
+#include "DateTime.h"
 
 // This is a utility function for the std::set comparisons.
 struct sorting_struct {
@@ -16,47 +25,264 @@ struct sorting_struct {
 	}
 };
 
+// Read only view of time ordered (time, price) rows, valid until the series it came from is modified.
+class TimePriceView {
+	std::span<const Timestamp> times;
+	std::span<const double> prices;
+
+public:
+	TimePriceView() = default;
+	TimePriceView(std::span<const Timestamp> timeView, std::span<const double> priceView) : times(timeView), prices(priceView) { }
+
+	// Iterators point into the columns, not the view, so they outlive a temporary view and compare
+	// equal across views of the same rows. Dereferencing yields a (time, price) pair by value.
+	class Iterator {
+		const Timestamp* time = nullptr;
+		const double* price = nullptr;
+
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = std::pair<Timestamp, double>;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = value_type;
+
+		Iterator() = default;
+		Iterator(const Timestamp* time, const double* price) : time(time), price(price) { }
+
+		value_type operator*() const { return { *time, *price }; }
+		Iterator& operator++() { time++; price++; return *this; }
+		Iterator operator++(int) { Iterator previous = *this; ++*this; return previous; }
+		bool operator==(const Iterator& other) const { return time == other.time; }
+	};
+
+	std::pair<Timestamp, double> operator[](size_t index) const noexcept { return { times[index], prices[index] }; }
+	Iterator begin() const noexcept { return Iterator(times.data(), prices.data()); }
+	Iterator end() const noexcept { return Iterator(times.data() + times.size(), prices.data() + prices.size()); }
+
+	size_t size() const noexcept { return times.size(); }
+	bool empty() const noexcept { return times.empty(); }
+
+	std::span<const Timestamp> getTimeView() const noexcept { return times; }
+	std::span<const double> getPriceView() const noexcept { return prices; }
+
+	TimePriceView subview(size_t first, size_t count) const noexcept {
+		return TimePriceView(times.subspan(first, count), prices.subspan(first, count));
+	}
+
+	// Rows with startTime <= time <= endTime in ticks, found by binary search.
+	TimePriceView between(Timestamp startTime, Timestamp endTime) const noexcept {
+		size_t first = std::lower_bound(times.begin(), times.end(), startTime) - times.begin();
+		size_t last = std::upper_bound(times.begin() + first, times.end(), endTime) - times.begin();
+		return subview(first, last - first);
+	}
+};
+
+// Two series on one time axis: row i holds the left and right prices at times[i], NaN where a side has none.
+struct AlignedSeries {
+	std::vector<Timestamp> times;
+	std::vector<double> left;
+	std::vector<double> right;
+};
+
+class TimeSeriesQuery;
+
 class TimeSeriesTransformations {
+	friend class TimeSeriesQuery;
+
 	void sortInternals();
+	void mergeSortedRuns(std::vector<size_t> runEnds);
+	void loadCsvBuffer(const char* first, const char* last, unsigned int threadCount);
+	void loadFile(const std::string& filenameAndPath, unsigned int threadCount);
 
 	const int decimalPlaces = 5;
-	std::vector<std::pair<int, double>> timePricePairs;
+
+	// Columns are stored separately and kept sorted by time, so price kernels read dense doubles.
+	// Times are ticks of length resolution, the unix second overloads below scale into ticks.
+	struct Columns {
+		std::vector<Timestamp> times;
+		std::vector<double> prices;
+	};
+
+	// Copies share the columns until one of them is modified (copy on write), every mutation goes
+	// through writableColumns which detaches this series first. Empty series all share one instance.
+	static std::shared_ptr<Columns> emptyColumns() noexcept;
+	std::shared_ptr<Columns> columns = emptyColumns();
+	TimeResolution resolution = TimeResolution::Seconds;
+
+	Columns& writableColumns();
+
+	// Aggregates cached between modifications. Appends update them in O(1), removals invalidate
+	// them and the next query recomputes them.
+	mutable SummaryStatistics priceAggregates;
+	mutable SummaryStatistics incrementAggregates;
+	mutable std::atomic<bool> priceAggregatesValid = false;
+	mutable std::atomic<bool> incrementAggregatesValid = false;
+
+	// Lazily built day index over the UTC days that hold rows, in order: the rows of day indexedDays[i]
+	// are [dayOffsets[i], dayOffsets[i + 1]), the last offset being the row count. Days without rows
+	// take no space, so sparse series stay small. Like the aggregates it is rebuilt by the first day
+	// query after a modification.
+	mutable std::vector<std::int64_t> indexedDays;
+	mutable std::vector<size_t> dayOffsets;
+	mutable std::atomic<bool> dayIndexValid = false;
+
+	// Const queries fill the caches above under cacheMutex and publish them through the valid flags,
+	// so any number of threads may query a series at once. Modifications must not run concurrently
+	// with queries or with each other.
+	mutable std::mutex cacheMutex;
+
+	void buildDayIndex() const;
+	// Extend a built index over the rows appended in order from firstNewRow, otherwise drop it.
+	void extendDayIndex(size_t firstNewRow, bool appendedInOrder);
+	std::pair<size_t, size_t> rowsOnDay(Timestamp unixEpochTime) const;
+	// Rows whose ticks fall in the seconds firstSecond to lastSecond inclusive.
+	std::pair<size_t, size_t> rowsInSeconds(Timestamp firstSecond, Timestamp lastSecond) const;
+
+	void invalidateCaches() noexcept;
+	bool eraseRange(size_t first, size_t last);
+	template <typename Predicate>
+	bool eraseRowsWhere(Predicate predicate);
 
 public:
 	// Constructors
 	TimeSeriesTransformations();
-	explicit TimeSeriesTransformations(const std::string& filenameAndPath);
+	// The csv time column holds ticks of the given resolution.
+	explicit TimeSeriesTransformations(const std::string& filenameAndPath, TimeResolution resolution = TimeResolution::Seconds);
 	TimeSeriesTransformations(const std::vector<int>& timeVec, const std::vector<double>& priceVec, const std::string& name = "");
+	TimeSeriesTransformations(TimeResolution resolution, const std::vector<Timestamp>& timeVec, const std::vector<double>& priceVec, const std::string& name = "");
+	// Copies are O(1) and share the columns until either side is modified, moves leave the source empty.
 	TimeSeriesTransformations(const TimeSeriesTransformations& TSSObject);
+	TimeSeriesTransformations(TimeSeriesTransformations&& TSSObject) noexcept;
+
+	// Loads a csv split into threadCount chunks, 0 picks a count from the file size and core count.
+	// The chunks run on at most one thread per core and per megabyte of the file.
+	static TimeSeriesTransformations load(const std::string& filenameAndPath, unsigned int threadCount = 0, TimeResolution resolution = TimeResolution::Seconds);
 
 	// Operator overloads.
 	TimeSeriesTransformations& operator=(const TimeSeriesTransformations& TTSObject);
+	TimeSeriesTransformations& operator=(TimeSeriesTransformations&& TTSObject) noexcept;
 	bool operator==(const TimeSeriesTransformations& TTSObject) const;
 
+	bool summary(SummaryStatistics* stats) const;
 	bool mean(double* meanValue) const;
 	bool standardDeviation(double* standardDeviationValue) const;
+	bool incrementSummary(SummaryStatistics* stats) const;
 	bool computeIncrementMean(double* meanValue) const;
 	bool computeIncrementStandardDeviation(double* standardDeviationValue) const;
-	void addASharePrice(const std::string& date, double price);
-	bool removeEntryAtTime(const std::string& date);
+	bool findGreatestIncrements(double* price_increment) const;
+	// Rolling mean, standard deviation, min and max of the window ending at each row, aligned with getView().
+	// Row windows hold the last windowRows prices, time windows the prices of the last windowSeconds seconds.
+	RollingStatistics rollingOverRows(size_t windowRows) const;
+	RollingStatistics rollingOverSeconds(Timestamp windowSeconds) const;
+	// OHLC bars over buckets of bucketSeconds seconds aligned to the epoch, e.g. 60 for one minute bars.
+	OhlcBars resample(Timestamp bucketSeconds) const;
+
+	// Linear merge joins with other, which must share this series' resolution. The as-of join keeps
+	// every row of this series with the last price of other at or before it. The inner join keeps the
+	// times present in both and the outer join the times present in either. Repeated times pair up
+	// every left row with every right row at that time.
+	AlignedSeries asOfJoin(const TimeSeriesTransformations& other) const;
+	AlignedSeries innerJoin(const TimeSeriesTransformations& other) const;
+	AlignedSeries outerJoin(const TimeSeriesTransformations& other) const;
+	void addSharePrices(const std::vector<int>& timeVec, const std::vector<double>& priceVec);
+	// Tick overloads of addASharePrice and addSharePrices, times are in the series resolution.
+	void addTick(Timestamp time, double price);
+	void addTicks(const std::vector<Timestamp>& timeVec, const std::vector<double>& priceVec);
 	bool removePricesGreaterThan(double price);
 	bool removePricesLowerThan(double price);
+
+	// Date string overloads parse the date and forward to the unix time versions below.
+	void addASharePrice(const std::string& date, double price);
+	bool removeEntryAtTime(const std::string& date);
 	bool removePricesBefore(const std::string& date);
 	bool removePricesAfter(const std::string& date);
 	std::string printSharePricesOnDate(const std::string& date) const;
 	std::string printIncrementsOnDate(const std::string& date) const;
-	bool findGreatestIncrements(double* price_increment) const;
 	bool getPriceAtDate(const std::string& date, double* value) const;
+	TimePriceView sliceBetween(const std::string& startDate, const std::string& endDate) const;
+
+	// Unix time overloads in 64 bit seconds, pair with the compile time "2021-04-22"_unix literal to skip parsing.
+	// Each second covers all of its ticks, so getPriceAtDate returns the first tick within that second.
+	void addASharePrice(Timestamp unixEpochTime, double price);
+	bool removeEntryAtTime(Timestamp unixEpochTime);
+	bool removePricesBefore(Timestamp unixEpochTime);
+	bool removePricesAfter(Timestamp unixEpochTime);
+	std::string printSharePricesOnDate(Timestamp unixEpochTime) const;
+	std::string printIncrementsOnDate(Timestamp unixEpochTime) const;
+	bool getPriceAtDate(Timestamp unixEpochTime, double* value) const;
+	TimePriceView sliceBetween(Timestamp startTime, Timestamp endTime) const;
+	// Every tick on the UTC day containing unixEpochTime.
+	TimePriceView pricesOnDay(Timestamp unixEpochTime) const;
+	// Lazy filters over this series, e.g. query().after(start).priceBelow(x).mean(&value).
+	TimeSeriesQuery query() const;
 	void saveData(const std::string& filename) const;
+	// Saves with prices rounded to precision decimal places, the default uses decimalPlaces.
+	void saveData(const std::string& filename, int precision) const;
+
+	// Compact native binary snapshot: header, then contiguous time and price columns.
+	void saveBinary(const std::string& filename) const;
+	static TimeSeriesTransformations loadBinary(const std::string& filenameAndPath);
+
 	size_t count() const noexcept;
 	std::string getName() const noexcept;
-	std::vector<std::pair<int, double>> getTimePricePairs() const noexcept;
+	TimeResolution getResolution() const noexcept;
+	// Throws std::overflow_error if a time does not fit in an int, use getView for wide timestamps.
+	std::vector<std::pair<int, double>> getTimePricePairs() const;
 
 	char getSeparator() const noexcept;
 	char separator = ',';
 
 	std::string name = "";
 
+	// Throws std::overflow_error if a time does not fit in an int.
 	std::vector<int> getTimeVector() const;
+	std::vector<Timestamp> getTimestampVector() const;
 	std::vector<double> getPriceVector() const;
+
+	// Read only views of the columns, valid until the series is next modified.
+	std::span<const Timestamp> getTimeView() const noexcept;
+	std::span<const double> getPriceView() const noexcept;
+	TimePriceView getView() const noexcept;
+};
+
+// Filters chained onto a series without modifying it, evaluated together in a single pass when a result
+// is asked for. The time bounds are found by binary search and only the price bounds are tested per row.
+// The query shares the columns of the series (see copy on write above), so it stays valid if the series
+// is later modified, at the cost of that modification copying the columns.
+class TimeSeriesQuery {
+	std::shared_ptr<const TimeSeriesTransformations::Columns> columns;
+	TimeResolution resolution = TimeResolution::Seconds;
+	std::string name;
+
+	// Inclusive bounds, rows outside them are dropped.
+	Timestamp firstTime = std::numeric_limits<Timestamp>::min();
+	Timestamp lastTime = std::numeric_limits<Timestamp>::max();
+	double lowestPrice = -std::numeric_limits<double>::infinity();
+	double highestPrice = std::numeric_limits<double>::infinity();
+
+	TimePriceView rowsInTimeBounds() const noexcept;
+	bool hasPriceBounds() const noexcept;
+	bool keepsPrice(double price) const noexcept;
+
+public:
+	explicit TimeSeriesQuery(const TimeSeriesTransformations& series);
+
+	// Keep the rows at or after unixEpochTime and at or before it (every tick of that second), like
+	// removePricesBefore and removePricesAfter. Bad date strings throw std::invalid_argument.
+	TimeSeriesQuery& after(Timestamp unixEpochTime);
+	TimeSeriesQuery& before(Timestamp unixEpochTime);
+	TimeSeriesQuery& after(const std::string& date);
+	TimeSeriesQuery& before(const std::string& date);
+	// Keep prices of at most and at least price, like removePricesGreaterThan and removePricesLowerThan.
+	TimeSeriesQuery& priceBelow(double price);
+	TimeSeriesQuery& priceAbove(double price);
+
+	// Results, none of which allocate except materialize.
+	size_t count() const noexcept;
+	bool summary(SummaryStatistics* stats) const noexcept;
+	bool mean(double* meanValue) const noexcept;
+	bool standardDeviation(double* standardDeviationValue) const noexcept;
+	// A new series holding the matching rows.
+	TimeSeriesTransformations materialize() const;
 };
@@ -2,13 +2,867 @@
 // This file contains the 'main' function.
 // Program execution begins and ends there.
 //
+// Runs the library benchmarks. With no arguments every benchmark runs at its default size,
+// otherwise pass the benchmark name and optionally a row count, e.g. "load 5000000".
+//
+#define _CRT_SECURE_NO_WARNINGS
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
 #include "..\TimeSeriesTransformations\TimeSeriesTransformations.h"
+#include "..\TimeSeriesTransformations\DateTime.h"
+#include "..\TimeSeriesTransformations\TimeSeriesPanel.h"
+#include "..\TimeSeriesTransformations\ConcurrentTimeSeries.h"
+#include "..\TimeSeriesTransformations\TickQueue.h"
+#include "..\TimeSeriesTransformations\ChunkedTimeSeries.h"
+
+// Time a callable and return the elapsed wall clock seconds.
+template <typename F>
+double timeSeconds(F&& f) {
+	auto start = std::chrono::steady_clock::now();
+	f();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+// Write a synthetic price file shaped like Problem3_DATA.csv.
+void writeSyntheticCsv(const std::string& filename, size_t rows) {
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<double> priceDistribution(1.0, 100.0);
+
+	std::ofstream csv(filename);
+	csv << "TIMESTAMP,ShareX\n";
+	csv << std::setprecision(10);
+
+	for (size_t i = 0; i < rows; i++) {
+		csv << 1619120010 + static_cast<int>(i) * 5 << ',' << priceDistribution(generator) << '\n';
+	}
+}
+
+// The getline/istringstream/stod loader the library used before the in place parser.
+size_t legacyLoad(const std::string& filename) {
+	std::vector<std::pair<int, double>> timePricePairs;
+	std::ifstream csv(filename);
+	std::string line, stringTime, stringPrice;
+	double powerOf10 = std::pow(10, 5);
+
+	std::getline(csv, line);
+
+	while (std::getline(csv, line)) {
+		std::istringstream iss{ line };
+
+		std::getline(iss, stringTime, ',');
+		std::getline(iss, stringPrice, ',');
+
+		int time = std::stoi(stringTime);
+		double price = std::round(std::stod(stringPrice) * powerOf10) / powerOf10;
+
+		timePricePairs.emplace_back(time, price);
+	}
+
+	return timePricePairs.size();
+}
+
+// The operator<< and std::endl writer saveData used before the buffered writer.
+void legacySave(const std::vector<std::pair<int, double>>& timePricePairs, const std::string& filename) {
+	std::ofstream newCSV(filename);
+	newCSV << "TIMESTAMP" << ',' << "ShareX" << std::endl;
+
+	for (const auto& pair : timePricePairs) {
+		newCSV << pair.first << ',' << pair.second << std::endl;
+	}
+}
+
+void benchmarkLoad(size_t rows) {
+	std::string filename = (std::filesystem::temp_directory_path() / "tss_benchmark_load.csv").string();
+	writeSyntheticCsv(filename, rows);
+
+	double megabytes = std::filesystem::file_size(filename) / (1024.0 * 1024.0);
+
+	double legacySeconds = timeSeconds([&] { legacyLoad(filename); });
+
+	size_t loadedRows = 0;
+	double fastSeconds = timeSeconds([&] { loadedRows = TimeSeriesTransformations(filename).count(); });
+
+	std::cout << "load: " << loadedRows << " rows, " << std::fixed << std::setprecision(1) << megabytes << " MB\n";
+	std::cout << "  getline/stod loader: " << megabytes / legacySeconds << " MB/s\n";
+	std::cout << "  in place loader:     " << megabytes / fastSeconds << " MB/s\n";
+
+	std::remove(filename.c_str());
+}
+
+void benchmarkBinary(size_t rows) {
+	std::string csvFilename = (std::filesystem::temp_directory_path() / "tss_benchmark_snapshot.csv").string();
+	std::string binaryFilename = (std::filesystem::temp_directory_path() / "tss_benchmark_snapshot.tsb").string();
+	writeSyntheticCsv(csvFilename, rows);
+
+	TimeSeriesTransformations series(csvFilename);
+
+	double csvSaveSeconds = timeSeconds([&] { series.saveData(csvFilename); });
+	double csvLoadSeconds = timeSeconds([&] { TimeSeriesTransformations reloaded(csvFilename); });
+	double binarySaveSeconds = timeSeconds([&] { series.saveBinary(binaryFilename); });
+	double binaryLoadSeconds = timeSeconds([&] { TimeSeriesTransformations::loadBinary(binaryFilename); });
+
+	std::cout << "binary: " << series.count() << " rows snapshot and reload\n" << std::fixed << std::setprecision(3);
+	std::cout << "  csv:    save " << csvSaveSeconds << " s, load " << csvLoadSeconds << " s\n";
+	std::cout << "  binary: save " << binarySaveSeconds << " s, load " << binaryLoadSeconds << " s\n";
+
+	std::remove(csvFilename.c_str());
+	std::remove(binaryFilename.c_str());
+}
+
+void benchmarkSave(size_t rows) {
+	std::string filename = (std::filesystem::temp_directory_path() / "tss_benchmark_save.csv").string();
+
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<double> priceDistribution(1.0, 100.0);
+	std::vector<int> times(rows);
+	std::vector<double> prices(rows);
+	for (size_t i = 0; i < rows; i++) {
+		times[i] = static_cast<int>(i);
+		prices[i] = std::round(priceDistribution(generator) * 1e5) / 1e5;
+	}
+
+	TimeSeriesTransformations series(times, prices, "ShareX");
+	std::vector<std::pair<int, double>> pairs = series.getTimePricePairs();
+
+	double legacySeconds = timeSeconds([&] { legacySave(pairs, filename); });
+	double bufferedSeconds = timeSeconds([&] { series.saveData(filename); });
+
+	std::cout << "save: " << rows << " rows\n" << std::fixed << std::setprecision(0);
+	std::cout << "  operator<< and std::endl: " << rows / legacySeconds << " rows/s\n";
+	std::cout << "  buffered to_chars:        " << rows / bufferedSeconds << " rows/s\n";
+
+	std::remove(filename.c_str());
+}
+
+// Random walk prices at one second intervals.
+TimeSeriesTransformations syntheticSeries(size_t rows) {
+	std::mt19937 generator(42);
+	std::normal_distribution<double> stepDistribution(0.0, 0.1);
+	std::vector<int> times(rows);
+	std::vector<double> prices(rows);
+
+	double price = 100.0;
+	for (size_t i = 0; i < rows; i++) {
+		price += stepDistribution(generator);
+		times[i] = 1619120010 + static_cast<int>(i);
+		prices[i] = price;
+	}
+
+	return TimeSeriesTransformations(times, prices, "ShareX");
+}
+
+// The mean, copy, pow and reduce standardDeviation used before the fused summary kernel. It sums its
+// own mean since series.mean is now served from the cached aggregates.
+double legacyStandardDeviation(const TimeSeriesTransformations& series) {
+	double sum = 0.0;
+	for (double price : series.getPriceView()) {
+		sum += price;
+	}
+	double meanVal = sum / series.count();
+
+	std::vector<double> transformedPrice = series.getPriceVector();
+	std::for_each(transformedPrice.begin(), transformedPrice.end(), [&](double& i) -> void { i = pow(i - meanVal, 2); });
+
+	double squares = std::reduce(transformedPrice.begin(), transformedPrice.end(), 0.0);
+	return std::sqrt((1.0 / double(series.count() - 1)) * squares);
+}
+
+void benchmarkStats(size_t rows) {
+	TimeSeriesTransformations series = syntheticSeries(rows);
+	const int repeats = 20;
+
+	double legacyResult = 0.0;
+	double legacySeconds = timeSeconds([&] {
+		for (int i = 0; i < repeats; i++) { legacyResult += legacyStandardDeviation(series); }
+		});
+
+	double summaryResult = 0.0;
+	double summarySeconds = timeSeconds([&] {
+		// Call the kernel directly, series.summary would time a cache hit after the first repeat.
+		for (int i = 0; i < repeats; i++) {
+			SummaryStatistics stats = summarize(series.getPriceView());
+			summaryResult += std::sqrt(stats.variance);
+		}
+		});
+
+	double gigabytes = repeats * rows * sizeof(double) / 1e9;
+	std::cout << "stats: " << rows << " prices, standard deviation " << summaryResult / repeats << "\n" << std::fixed << std::setprecision(2);
+	std::cout << "  mean + copy + pow + reduce: " << gigabytes / legacySeconds << " GB/s\n";
+	std::cout << "  single pass summary:        " << gigabytes / summarySeconds << " GB/s\n";
+}
+
+// Format a unix timestamp the way addASharePrice expects it.
+std::string formatDate(int unixTime) {
+	std::time_t time = unixTime;
+	std::tm calendar = *std::gmtime(&time);
+
+	std::ostringstream stream;
+	stream << std::put_time(&calendar, "%Y-%m-%d %H:%M:%S");
+	return stream.str();
+}
+
+void benchmarkIngest(size_t ticks) {
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<double> priceDistribution(1.0, 100.0);
+	std::vector<int> times(ticks);
+	std::vector<double> prices(ticks);
+	std::vector<std::string> dates(ticks);
+	for (size_t i = 0; i < ticks; i++) {
+		times[i] = 86400 + static_cast<int>(i);
+		prices[i] = priceDistribution(generator);
+		dates[i] = formatDate(times[i]);
+	}
+
+	// The old emplace_back and full std::sort per tick is quadratic, so it only gets a prefix.
+	size_t legacyTicks = std::min<size_t>(ticks, 20000);
+	std::vector<std::pair<int, double>> legacyPairs;
+	double legacySeconds = timeSeconds([&] {
+		for (size_t i = 0; i < legacyTicks; i++) {
+			legacyPairs.emplace_back(times[i], prices[i]);
+			std::sort(legacyPairs.begin(), legacyPairs.end(), [](const auto& left, const auto& right) { return left.first < right.first; });
+		}
+		});
+
+	TimeSeriesTransformations oneByOne;
+	double oneByOneSeconds = timeSeconds([&] {
+		for (size_t i = 0; i < ticks; i++) { oneByOne.addASharePrice(dates[i], prices[i]); }
+		});
+
+	const size_t batchSize = 1000;
+	TimeSeriesTransformations batched;
+	double batchedSeconds = timeSeconds([&] {
+		for (size_t start = 0; start < ticks; start += batchSize) {
+			size_t end = std::min(start + batchSize, ticks);
+			batched.addSharePrices(std::vector<int>(times.begin() + start, times.begin() + end), std::vector<double>(prices.begin() + start, prices.begin() + end));
+		}
+		});
+
+	std::cout << "ingest: " << ticks << " ticks\n" << std::fixed << std::setprecision(0);
+	std::cout << "  emplace_back + std::sort per tick (first " << legacyTicks << "): " << legacyTicks / legacySeconds << " ticks/s\n";
+	std::cout << "  addASharePrice one by one (includes date parsing): " << ticks / oneByOneSeconds << " ticks/s\n";
+	std::cout << "  addSharePrices in batches of " << batchSize << ": " << ticks / batchedSeconds << " ticks/s\n";
+}
+
+// The istringstream, get_time, mktime and format back and compare path dates used to take.
+bool legacyParseDate(const std::string& date, int* unixEpoch) {
+	std::tm t{};
+	std::istringstream stringStream(date);
+	stringStream >> std::get_time(&t, date.size() == 10 ? "%Y-%m-%d" : "%Y-%m-%d %H:%M:%S");
+	if (stringStream.fail()) { return false; }
+
+	*unixEpoch = static_cast<int>(mktime(&t));
+	std::string comparisonDate = formatDate(*unixEpoch);
+
+	return comparisonDate == date || (comparisonDate.substr(11) == "00:00:00" && comparisonDate.substr(0, 10) == date);
+}
+
+void benchmarkDates(size_t count) {
+	std::vector<std::string> dates(count);
+	for (size_t i = 0; i < count; i++) {
+		dates[i] = formatDate(1619120010 + static_cast<int>(i) * 37);
+	}
+
+	long long checksum = 0;
+	double legacySeconds = timeSeconds([&] {
+		for (const auto& date : dates) {
+			int unixEpoch = 0;
+			legacyParseDate(date, &unixEpoch);
+			checksum += unixEpoch;
+		}
+		});
+
+	double parserSeconds = timeSeconds([&] {
+		for (const auto& date : dates) {
+			Timestamp unixEpoch = 0;
+			parseDateTime(date, &unixEpoch);
+			checksum += unixEpoch;
+		}
+		});
+
+	std::cout << "dates: " << count << " parses (checksum " << checksum << ")\n" << std::fixed << std::setprecision(0);
+	std::cout << "  get_time + mktime + validate: " << count / legacySeconds << " parses/s\n";
+	std::cout << "  parseDateTime:                " << count / parserSeconds << " parses/s\n";
+}
+
+// The copy, two erase passes and string concatenation printSharePricesOnDate used before the day index.
+std::string legacyPricesOnDay(const TimeSeriesTransformations& series, int dayStart) {
+	TimeSeriesTransformations copy(series.getTimeVector(), series.getPriceVector());
+	copy.removePricesBefore(dayStart);
+	copy.removePricesAfter(dayStart + 86400 - 1);
+
+	std::string stringOfPrices = "";
+	for (double price : copy.getPriceView()) {
+		stringOfPrices += std::to_string(price) + "\n";
+	}
+	return stringOfPrices;
+}
+
+void benchmarkDays(size_t rows) {
+	TimeSeriesTransformations series = syntheticSeries(rows);
+	int firstDay = static_cast<int>(series.getTimeView().front() / 86400 * 86400);
+	int dayCount = static_cast<int>((series.getTimeView().back() - firstDay) / 86400 + 1);
+
+	// The legacy path copies the whole series per query, so it only gets a few days.
+	int legacyDays = std::min(dayCount, 5);
+	size_t legacyCharacters = 0;
+	double legacySeconds = timeSeconds([&] {
+		for (int day = 0; day < legacyDays; day++) { legacyCharacters += legacyPricesOnDay(series, firstDay + day * 86400).size(); }
+		});
+
+	size_t indexedCharacters = 0;
+	double indexedSeconds = timeSeconds([&] {
+		for (int day = 0; day < dayCount; day++) { indexedCharacters += series.printSharePricesOnDate(firstDay + day * 86400).size(); }
+		});
+
+	size_t incrementCharacters = 0;
+	double incrementSeconds = timeSeconds([&] {
+		for (int day = 0; day < dayCount; day++) { incrementCharacters += series.printIncrementsOnDate(firstDay + day * 86400).size(); }
+		});
+
+	std::cout << "days: " << rows << " rows over " << dayCount << " days\n" << std::fixed << std::setprecision(1);
+	std::cout << "  copy + erase + concatenate (first " << legacyDays << "): " << legacySeconds * 1e3 / legacyDays << " ms/day\n";
+	std::cout << "  day index printSharePricesOnDate:     " << indexedSeconds * 1e3 / dayCount << " ms/day\n";
+	std::cout << "  day index printIncrementsOnDate:      " << incrementSeconds * 1e3 / dayCount << " ms/day\n";
+}
+
+// Rolling statistics by slicing out every window and summarising it, O(n * w).
+void benchmarkRolling(size_t rows) {
+	TimeSeriesTransformations series = syntheticSeries(rows);
+	std::span<const double> prices = series.getPriceView();
+	const size_t windowRows = 1000;
+
+	// The per window path is far slower, so it only gets a prefix.
+	size_t slicedRows = std::min<size_t>(rows, 200000);
+	double slicedChecksum = 0.0;
+	double slicedSeconds = timeSeconds([&] {
+		for (size_t i = 0; i < slicedRows; i++) {
+			size_t first = (i + 1 > windowRows) ? i + 1 - windowRows : 0;
+			SummaryStatistics window = summarize(prices.subspan(first, i - first + 1));
+			slicedChecksum += window.mean;
+		}
+		});
+
+	RollingStatistics rolling;
+	double rollingSeconds = timeSeconds([&] { rolling = series.rollingOverRows(windowRows); });
+	double timeWindowSeconds = timeSeconds([&] { rolling = series.rollingOverSeconds(static_cast<int>(windowRows)); });
+
+	std::cout << "rolling: " << rows << " rows, window " << windowRows << " (last mean " << rolling.mean.back() << ")\n" << std::fixed << std::setprecision(0);
+	std::cout << "  summarize per window (first " << slicedRows << "): " << slicedRows / slicedSeconds << " rows/s\n";
+	std::cout << "  rollingOverRows:    " << rows / rollingSeconds << " rows/s\n";
+	std::cout << "  rollingOverSeconds: " << rows / timeWindowSeconds << " rows/s\n";
+}
+
+// OHLC bars built outside the library from a getTimePricePairs copy, the way consumers used to.
+size_t legacyResample(const std::vector<std::pair<int, double>>& pairs, int bucketSeconds, std::vector<double>* closes) {
+	size_t bars = 0;
+	int currentBucket = 0;
+	double open = 0, high = 0, low = 0, close = 0;
+
+	for (size_t i = 0; i < pairs.size(); i++) {
+		int bucket = pairs[i].first / bucketSeconds;
+		if (i == 0 || bucket != currentBucket) {
+			if (i > 0) { closes->push_back(close + open + high + low); }
+			currentBucket = bucket;
+			open = high = low = pairs[i].second;
+			bars++;
+		}
+		high = std::max(high, pairs[i].second);
+		low = std::min(low, pairs[i].second);
+		close = pairs[i].second;
+	}
+
+	return bars;
+}
+
+void benchmarkResample(size_t rows) {
+	// Generated straight into the tick columns, 100M rows do not leave room for a series and its copies.
+	std::vector<Timestamp> times(rows);
+	std::vector<double> prices(rows);
+	std::mt19937 generator(42);
+	std::normal_distribution<double> stepDistribution(0.0, 0.1);
+	double price = 100.0;
+	for (size_t i = 0; i < rows; i++) {
+		price += stepDistribution(generator);
+		// Roughly four ticks a second.
+		times[i] = 1619120010000 + static_cast<Timestamp>(i) * 250;
+		prices[i] = price;
+	}
+
+	std::cout << "resample: " << rows << " millisecond ticks\n" << std::fixed << std::setprecision(0);
+
+	// The legacy route needs int seconds and a pair copy, so it only gets a prefix.
+	size_t legacyRows = std::min<size_t>(rows, 10000000);
+	std::vector<int> legacyTimes(legacyRows);
+	std::transform(times.begin(), times.begin() + legacyRows, legacyTimes.begin(), [](Timestamp time) { return static_cast<int>(time / 1000); });
+	TimeSeriesTransformations legacySeries(legacyTimes, std::vector<double>(prices.begin(), prices.begin() + legacyRows));
+	std::vector<double> closes;
+	double legacySeconds = timeSeconds([&] { legacyResample(legacySeries.getTimePricePairs(), 60, &closes); });
+	std::cout << "  getTimePricePairs + external loop (first " << legacyRows << "): " << legacyRows / legacySeconds << " ticks/s\n";
+
+	const int bucketSeconds[4] = { 1, 60, 3600, 86400 };
+	for (int seconds : bucketSeconds) {
+		OhlcBars bars;
+		double resampleSeconds = timeSeconds([&] { bars = resampleOhlc(times, prices, seconds * 1000LL); });
+		std::cout << "  resampleOhlc " << seconds << "s bars (" << bars.start.size() << " bars): " << rows / resampleSeconds << " ticks/s\n";
+	}
+}
+
+// Summaries of many tickers, each as its own series against one panel arena.
+void benchmarkPanel(size_t rows) {
+	const size_t tickers = 2000;
+	size_t rowsPerTicker = std::max<size_t>(rows / tickers, 1);
+
+	std::vector<TimeSeriesTransformations> separate;
+	TimeSeriesPanel panel;
+	std::mt19937 generator(42);
+	std::normal_distribution<double> stepDistribution(0.0, 0.1);
+	for (size_t ticker = 0; ticker < tickers; ticker++) {
+		std::vector<int> times(rowsPerTicker);
+		std::vector<double> prices(rowsPerTicker);
+		double price = 100.0;
+		for (size_t i = 0; i < rowsPerTicker; i++) {
+			price += stepDistribution(generator);
+			times[i] = 1619120010 + static_cast<int>(i);
+			prices[i] = price;
+		}
+		separate.emplace_back(times, prices, "Share" + std::to_string(ticker));
+		panel.addSeries(separate.back());
+	}
+
+	double separateMeans = 0.0;
+	double separateSeconds = timeSeconds([&] {
+		for (const auto& series : separate) {
+			// Copies stand in for a fresh query, the series would otherwise answer from its cache.
+			SummaryStatistics stats = summarize(series.getPriceVector());
+			separateMeans += stats.mean;
+		}
+		});
+
+	double panelMeans = 0.0;
+	double singleSeconds = timeSeconds([&] {
+		for (const auto& stats : panel.summaries(1)) { panelMeans += stats.mean; }
+		});
+	double parallelSeconds = timeSeconds([&] {
+		for (const auto& stats : panel.summaries()) { panelMeans += stats.mean; }
+		});
+
+	std::cout << "panel: " << tickers << " tickers of " << rowsPerTicker << " rows (mean " << separateMeans / tickers << ")\n" << std::fixed << std::setprecision(0);
+	std::cout << "  separate series: " << tickers * rowsPerTicker / separateSeconds << " rows/s\n";
+	std::cout << "  panel, 1 thread: " << tickers * rowsPerTicker / singleSeconds << " rows/s\n";
+	std::cout << "  panel, parallel: " << tickers * rowsPerTicker / parallelSeconds << " rows/s (" << std::max(1u, std::thread::hardware_concurrency()) << " cores)\n";
+}
+
+// An as-of join written against getTimePricePairs copies with a std::map lookup per row.
+size_t legacyAsOfJoin(const TimeSeriesTransformations& left, const TimeSeriesTransformations& right, double* checksum) {
+	std::vector<std::pair<int, double>> leftPairs = left.getTimePricePairs();
+	std::vector<std::pair<int, double>> rightPairs = right.getTimePricePairs();
+	std::map<int, double> rightByTime(rightPairs.begin(), rightPairs.end());
+
+	size_t matched = 0;
+	for (const auto& pair : leftPairs) {
+		auto after = rightByTime.upper_bound(pair.first);
+		if (after != rightByTime.begin()) {
+			*checksum += std::prev(after)->second - pair.second;
+			matched++;
+		}
+	}
+	return matched;
+}
+
+void benchmarkJoin(size_t rows) {
+	TimeSeriesTransformations left = syntheticSeries(rows);
+	// The right series ticks every third second, offset so the as-of lookups land between ticks.
+	std::vector<int> rightTimes(rows / 3);
+	std::vector<double> rightPrices(rows / 3);
+	for (size_t i = 0; i < rightTimes.size(); i++) {
+		rightTimes[i] = 1619120011 + static_cast<int>(i) * 3;
+		rightPrices[i] = 50.0 + i % 17;
+	}
+	TimeSeriesTransformations right(rightTimes, rightPrices, "ShareY");
+
+	double checksum = 0.0;
+	double legacySeconds = timeSeconds([&] { legacyAsOfJoin(left, right, &checksum); });
+
+	AlignedSeries aligned;
+	double asOfSeconds = timeSeconds([&] { aligned = left.asOfJoin(right); });
+	double innerSeconds = timeSeconds([&] { aligned = left.innerJoin(right); });
+	double outerSeconds = timeSeconds([&] { aligned = left.outerJoin(right); });
+
+	std::cout << "join: " << rows << " rows against " << right.count() << " rows\n" << std::fixed << std::setprecision(0);
+	std::cout << "  pair copies + std::map as-of: " << rows / legacySeconds << " rows/s\n";
+	std::cout << "  asOfJoin:  " << rows / asOfSeconds << " rows/s\n";
+	std::cout << "  innerJoin: " << rows / innerSeconds << " rows/s\n";
+	std::cout << "  outerJoin: " << rows / outerSeconds << " rows/s (" << aligned.times.size() << " rows)\n";
+}
+
+// Random binary searches over a sorted time column of the given width.
+template <typename Time>
+double timeSearches(const std::vector<Time>& times, const std::vector<Time>& targets, size_t* checksum) {
+	return timeSeconds([&] {
+		for (Time target : targets) { *checksum += std::lower_bound(times.begin(), times.end(), target) - times.begin(); }
+		});
+}
+
+// The 32 bit second layout against the 64 bit tick layout, for searches and a sequential pass over the times.
+void benchmarkTimestamps(size_t rows) {
+	std::vector<int> narrowTimes(rows);
+	std::vector<Timestamp> wideTimes(rows);
+	for (size_t i = 0; i < rows; i++) {
+		narrowTimes[i] = 1619120010 + static_cast<int>(i);
+		wideTimes[i] = narrowTimes[i];
+	}
+
+	const size_t searches = 2000000;
+	std::mt19937 generator(42);
+	std::uniform_int_distribution<size_t> rowDistribution(0, rows - 1);
+	std::vector<int> narrowTargets(searches);
+	std::vector<Timestamp> wideTargets(searches);
+	for (size_t i = 0; i < searches; i++) {
+		narrowTargets[i] = narrowTimes[rowDistribution(generator)];
+		wideTargets[i] = narrowTargets[i];
+	}
+
+	size_t checksum = 0;
+	double narrowSearchSeconds = timeSearches(narrowTimes, narrowTargets, &checksum);
+	double wideSearchSeconds = timeSearches(wideTimes, wideTargets, &checksum);
+
+	long long narrowSum = 0, wideSum = 0;
+	double narrowScanSeconds = timeSeconds([&] { narrowSum = std::accumulate(narrowTimes.begin(), narrowTimes.end(), 0LL); });
+	double wideScanSeconds = timeSeconds([&] { wideSum = std::accumulate(wideTimes.begin(), wideTimes.end(), 0LL); });
+
+	std::cout << "timestamps: " << rows << " rows, " << searches << " searches (checksum " << checksum + narrowSum - wideSum << ")\n" << std::fixed << std::setprecision(0);
+	std::cout << "  int32 lower_bound: " << searches / narrowSearchSeconds << " searches/s\n";
+	std::cout << "  int64 lower_bound: " << searches / wideSearchSeconds << " searches/s\n";
+	std::cout << std::setprecision(2);
+	std::cout << "  int32 scan: " << rows * sizeof(int) / narrowScanSeconds / 1e9 << " GB/s\n";
+	std::cout << "  int64 scan: " << rows * sizeof(Timestamp) / wideScanSeconds / 1e9 << " GB/s\n";
+}
+
+// Copies of a series share its columns, so only the copy that is filtered pays for its own storage.
+void benchmarkCopies(size_t rows) {
+	TimeSeriesTransformations series = syntheticSeries(rows);
+	const size_t copies = 20;
+
+	std::vector<TimeSeriesTransformations> shared;
+	double copySeconds = timeSeconds([&] {
+		for (size_t i = 0; i < copies; i++) { shared.push_back(series); }
+		});
+
+	std::vector<TimeSeriesTransformations> deep;
+	double deepSeconds = timeSeconds([&] {
+		for (size_t i = 0; i < copies; i++) {
+			deep.emplace_back(series.getResolution(), series.getTimestampVector(), series.getPriceVector(), series.getName());
+		}
+		});
+
+	double mean = 0.0;
+	double filterSeconds = timeSeconds([&] {
+		TimeSeriesTransformations filtered = series;
+		series.mean(&mean);
+		filtered.removePricesGreaterThan(mean);
+		filtered.mean(&mean);
+		});
+
+	double moveSeconds = timeSeconds([&] {
+		TimeSeriesTransformations moved = std::move(shared.back());
+		shared.back() = std::move(moved);
+		});
+
+	std::cout << "copies: " << copies << " copies of " << rows << " rows (filtered mean " << mean << ")\n" << std::fixed << std::setprecision(6);
+	std::cout << "  deep copies:   " << deepSeconds << " s\n";
+	std::cout << "  shared copies: " << copySeconds << " s\n";
+	std::cout << "  copy, filter and mean: " << filterSeconds << " s\n";
+	std::cout << "  move and move back: " << moveSeconds << " s\n";
+}
+
+// Filtering a copy with the four removal passes against one fused lazy query over the same rows.
+void benchmarkQuery(size_t rows) {
+	TimeSeriesTransformations series = syntheticSeries(rows);
+	int start = 1619120010 + static_cast<int>(rows / 4);
+	int end = 1619120010 + static_cast<int>(rows / 4 * 3);
+	double median = series.getPriceVector()[rows / 2];
+
+	double eagerMean = 0.0;
+	double eagerSeconds = timeSeconds([&] {
+		TimeSeriesTransformations filtered = series;
+		filtered.removePricesBefore(start);
+		filtered.removePricesAfter(end);
+		filtered.removePricesGreaterThan(median + 5);
+		filtered.removePricesLowerThan(median - 5);
+		filtered.mean(&eagerMean);
+		});
+
+	double lazyMean = 0.0;
+	double lazySeconds = timeSeconds([&] {
+		series.query().after(start).before(end).priceBelow(median + 5).priceAbove(median - 5).mean(&lazyMean);
+		});
+
+	size_t materialized = 0;
+	double materializeSeconds = timeSeconds([&] {
+		materialized = series.query().after(start).before(end).priceBelow(median + 5).priceAbove(median - 5).materialize().count();
+		});
+
+	std::cout << "query: " << rows << " rows, " << materialized << " kept (means " << eagerMean << " " << lazyMean << ")\n" << std::fixed << std::setprecision(0);
+	std::cout << "  copy + removal passes + mean: " << rows / eagerSeconds << " rows/s\n";
+	std::cout << "  query mean: " << rows / lazySeconds << " rows/s\n";
+	std::cout << "  query materialize: " << rows / materializeSeconds << " rows/s\n";
+}
+
+// Run readerCount threads calling read(iteration) while this thread calls write(i) for every tick,
+// and return the reads per second achieved across all readers.
+template <typename Write, typename Read>
+double readsWhileWriting(unsigned int readerCount, size_t ticks, Write write, Read read) {
+	std::atomic<bool> writing = true;
+	std::atomic<size_t> reads = 0;
+
+	std::vector<std::thread> readers;
+	for (unsigned int reader = 0; reader < readerCount; reader++) {
+		readers.emplace_back([&] {
+			size_t done = 0;
+			while (writing.load(std::memory_order_relaxed)) { read(done++); }
+			reads += done;
+			});
+	}
+
+	double seconds = timeSeconds([&] {
+		for (size_t i = 0; i < ticks; i++) { write(i); }
+		writing = false;
+		for (auto& reader : readers) { reader.join(); }
+		});
+
+	return reads / seconds;
+}
+
+// Read throughput with one writer appending, a mutex around an ordinary series against the lock free
+// concurrent series, as the reader count grows. Each read is a mean and a price lookup.
+void benchmarkConcurrent(size_t ticks) {
+	const int firstTime = 1619120010;
+	std::cout << "concurrent: " << ticks << " ticks appended, " << std::thread::hardware_concurrency() << " cores\n" << std::fixed << std::setprecision(0);
+
+	for (unsigned int readerCount = 1; readerCount <= 8; readerCount *= 2) {
+		TimeSeriesTransformations locked;
+		std::mutex lock;
+		double lockedReads = readsWhileWriting(readerCount, ticks,
+			[&](size_t i) { std::lock_guard<std::mutex> guard(lock); locked.addASharePrice(firstTime + static_cast<int>(i), double(i % 100)); },
+			[&](size_t i) {
+				std::lock_guard<std::mutex> guard(lock);
+				double value;
+				locked.mean(&value);
+				locked.getPriceAtDate(firstTime + static_cast<int>(i % (locked.count() + 1)), &value);
+			});
+
+		ConcurrentTimeSeries concurrent;
+		double concurrentReads = readsWhileWriting(readerCount, ticks,
+			[&](size_t i) { concurrent.addASharePrice(firstTime + static_cast<int>(i), double(i % 100)); },
+			[&](size_t i) {
+				double value;
+				concurrent.mean(&value);
+				concurrent.getPriceAtDate(firstTime + static_cast<int>(i % (concurrent.count() + 1)), &value);
+			});
+
+		std::cout << "  " << readerCount << " readers: mutex " << lockedReads << " reads/s, lock free " << concurrentReads << " reads/s\n";
+	}
+}
+
+// Print the percentiles of a set of latencies in nanoseconds.
+void printLatencies(const std::string& label, std::vector<double> latencies) {
+	std::sort(latencies.begin(), latencies.end());
+	auto percentile = [&](double fraction) { return latencies[static_cast<size_t>(fraction * (latencies.size() - 1))]; };
+
+	std::cout << "  " << label << ": p50 " << percentile(0.5) << " ns, p99 " << percentile(0.99) << " ns, p99.9 "
+		<< percentile(0.999) << " ns, max " << latencies.back() << " ns\n";
+}
+
+// Latency of each push from a market data thread while a consumer drains into a series, the queue
+// against taking a mutex and calling addTick directly.
+void benchmarkTickQueue(size_t ticks) {
+	using Clock = std::chrono::steady_clock;
+	const Timestamp firstTime = 1619120010;
+	std::vector<double> latencies(ticks);
+	std::cout << "tickqueue: " << ticks << " ticks\n" << std::fixed << std::setprecision(0);
+
+	TimeSeriesTransformations locked;
+	std::mutex lock;
+	std::atomic<bool> producing = true;
+	std::thread reader([&] {
+		while (producing) {
+			std::lock_guard<std::mutex> guard(lock);
+			double value;
+			locked.mean(&value);
+		}
+		});
+	for (size_t i = 0; i < ticks; i++) {
+		Clock::time_point start = Clock::now();
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			locked.addTick(firstTime + i, double(i % 100));
+		}
+		latencies[i] = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+	}
+	producing = false;
+	reader.join();
+	printLatencies("mutex + addTick", latencies);
+
+	TickQueue queue(1 << 16);
+	TimeSeriesTransformations drained;
+	size_t rejected = 0;
+	producing = true;
+	std::thread consumer([&] {
+		while (producing || queue.size() != 0) {
+			if (queue.drainInto(drained) == 0) { std::this_thread::yield(); }
+		}
+		});
+	for (size_t i = 0; i < ticks; i++) {
+		Clock::time_point start = Clock::now();
+		while (!queue.tryPush(firstTime + i, double(i % 100))) {
+			rejected++;
+			std::this_thread::yield();
+		}
+		latencies[i] = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+	}
+	producing = false;
+	consumer.join();
+	printLatencies("TickQueue::tryPush", latencies);
+	std::cout << "  " << drained.count() << " ticks drained, " << rejected << " pushes found the queue full\n";
+}
+
+// Time every append, returning the total seconds and filling the slowest append and how many took
+// over 100 microseconds.
+template <typename Append>
+double timeAppends(size_t ticks, Append append, double* slowestSeconds, size_t* stalls) {
+	using Clock = std::chrono::steady_clock;
+	*slowestSeconds = 0.0;
+	*stalls = 0;
+
+	return timeSeconds([&] {
+		for (size_t i = 0; i < ticks; i++) {
+			Clock::time_point start = Clock::now();
+			append(i);
+			double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+			*slowestSeconds = std::max(*slowestSeconds, seconds);
+			*stalls += seconds > 100e-6;
+		}
+		});
+}
+
+// Appending to the vector backed series against the chunked one, then range statistics on each.
+void benchmarkChunked(size_t ticks) {
+	const int firstTime = 1619120010;
+	double slowest;
+	size_t stalls;
+
+	TimeSeriesTransformations contiguous;
+	double contiguousSeconds = timeAppends(ticks, [&](size_t i) { contiguous.addTick(firstTime + i, double(i % 100)); }, &slowest, &stalls);
+	std::cout << "chunked: " << ticks << " appends\n" << std::fixed << std::setprecision(0);
+	std::cout << "  vector columns:  " << ticks / contiguousSeconds << " appends/s, slowest " << slowest * 1e3 << " ms, " << stalls << " over 100us\n";
+
+	ChunkedTimeSeries chunked;
+	double chunkedSeconds = timeAppends(ticks, [&](size_t i) { chunked.addTick(firstTime + i, double(i % 100)); }, &slowest, &stalls);
+	std::cout << "  chunked columns: " << ticks / chunkedSeconds << " appends/s, slowest " << slowest * 1e3 << " ms, " << stalls << " over 100us\n";
+
+	// Ranges covering the middle half of the series.
+	const size_t queries = 20;
+	int start = firstTime + static_cast<int>(ticks / 4);
+	int end = firstTime + static_cast<int>(ticks / 4 * 3);
+	SummaryStatistics stats;
+	double contiguousRangeSeconds = timeSeconds([&] {
+		for (size_t i = 0; i < queries; i++) { stats = summarize(contiguous.sliceBetween(start, end + static_cast<int>(i)).getPriceView()); }
+		});
+	double chunkedRangeSeconds = timeSeconds([&] {
+		for (size_t i = 0; i < queries; i++) { chunked.summaryBetween(start, end + static_cast<int>(i), &stats); }
+		});
+
+	double rowsSummarized = double(queries) * (ticks / 2);
+	std::cout << "  range summary, vector columns:  " << rowsSummarized / contiguousRangeSeconds << " rows/s\n";
+	std::cout << "  range summary, chunked columns: " << rowsSummarized / chunkedRangeSeconds << " rows/s (mean " << std::setprecision(3) << stats.mean << ")\n";
+}
+
+int main(int argc, char* argv[]) {
+	std::string benchmark = (argc > 1) ? argv[1] : "all";
+	size_t rows = (argc > 2) ? std::stoull(argv[2]) : 0;
+
+	if (benchmark == "all" || benchmark == "load") {
+		benchmarkLoad(rows ? rows : 2000000);
+	}
+
+	if (benchmark == "all" || benchmark == "save") {
+		benchmarkSave(rows ? rows : 10000000);
+	}
+
+	if (benchmark == "all" || benchmark == "binary") {
+		benchmarkBinary(rows ? rows : 2000000);
+	}
+
+	if (benchmark == "all" || benchmark == "stats") {
+		benchmarkStats(rows ? rows : 10000000);
+	}
+
+	if (benchmark == "all" || benchmark == "ingest") {
+		benchmarkIngest(rows ? rows : 1000000);
+	}
+
+	if (benchmark == "all" || benchmark == "dates") {
+		benchmarkDates(rows ? rows : 1000000);
+	}
+
+	if (benchmark == "all" || benchmark == "days") {
+		benchmarkDays(rows ? rows : 10000000);
+	}
+
+	if (benchmark == "all" || benchmark == "rolling") {
+		benchmarkRolling(rows ? rows : 10000000);
+	}
+
+	if (benchmark == "all" || benchmark == "resample") {
+		benchmarkResample(rows ? rows : 100000000);
+	}
+
+	if (benchmark == "all" || benchmark == "panel") {
+		benchmarkPanel(rows ? rows : 10000000);
+	}
+
+	if (benchmark == "all" || benchmark == "join") {
+		benchmarkJoin(rows ? rows : 10000000);
+	}
+
+	if (benchmark == "all" || benchmark == "timestamps") {
+		benchmarkTimestamps(rows ? rows : 10000000);
+	}
+
+	if (benchmark == "all" || benchmark == "copies") {
+		benchmarkCopies(rows ? rows : 10000000);
+	}
+
+	if (benchmark == "all" || benchmark == "query") {
+		benchmarkQuery(rows ? rows : 10000000);
+	}
+
+	if (benchmark == "all" || benchmark == "concurrent") {
+		benchmarkConcurrent(rows ? rows : 2000000);
+	}
+
+	if (benchmark == "all" || benchmark == "tickqueue") {
+		benchmarkTickQueue(rows ? rows : 2000000);
+	}
 
-int main() {
-	// I don't really see why I would need this given we have test.cpp
-	std::cout << "Application that does nothing." << std::endl;
+	if (benchmark == "all" || benchmark == "chunked") {
+		benchmarkChunked(rows ? rows : 50000000);
+	}
 }